@@ -0,0 +1,364 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Ленточные и трёхдиагональные матрицы
+
+#ifndef __TBanded_H__
+#define __TBanded_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include "tmatrix.h"
+#include "tsemiring.h"
+
+// Ленточная матрица n x n с kl поддиагоналями и ku наддиагоналями.
+// Хранится по диагоналям: диагональ d (от -kl до ku) - вектор длины n,
+// элемент (i, i + d) лежит в нём под номером i, остальные позиции нулевые.
+// Память O(n (kl + ku + 1)), размер ограничен MAX_VECTOR_SIZE, а не
+// MAX_MATRIX_SIZE; все операции проходят диагонали подряд за
+// O(n * ширина ленты)
+template<typename T>
+class TBandMatrix
+{
+protected:
+  size_t sz, kl, ku;
+  TDynamicVector<TDynamicVector<T>> diags;
+
+  static constexpr size_t ROW_BLOCK = 4096; // строк на блок произведения на вектор
+
+  TDynamicVector<T>& diag(ptrdiff_t d) { return diags[static_cast<size_t>(d + static_cast<ptrdiff_t>(kl))]; }
+  const TDynamicVector<T>& diag(ptrdiff_t d) const { return diags[static_cast<size_t>(d + static_cast<ptrdiff_t>(kl))]; }
+
+  // границы i, при которых (i, i + d) внутри матрицы
+  size_t first_row(ptrdiff_t d) const noexcept { return d < 0 ? std::min(sz, static_cast<size_t>(-d)) : 0; }
+  size_t last_row(ptrdiff_t d) const noexcept { return d > 0 ? sz - std::min(sz, static_cast<size_t>(d)) : sz; }
+
+public:
+  TBandMatrix(size_t n, size_t lower, size_t upper) : sz(n), kl(lower), ku(upper), diags(lower + upper + 1)
+  {
+    if (sz == 0) throw out_of_range("Matrix size should be greater than zero");
+    if (sz > MAX_VECTOR_SIZE) throw out_of_range("Matrix size should be less than the maximum");
+    if (kl > MAX_MATRIX_SIZE || ku > MAX_MATRIX_SIZE) throw out_of_range("Bandwidth should be less than the maximum");
+    for (size_t d = 0; d < diags.size(); ++d)
+      diags[d] = TDynamicVector<T>(sz);
+  }
+
+  // лента из плотной матрицы; элементы вне ленты отбрасываются
+  static TBandMatrix from_dense(const TDynamicMatrix<T>& m, size_t lower, size_t upper)
+  {
+    TBandMatrix b(m.size(), lower, upper);
+    for (ptrdiff_t d = -static_cast<ptrdiff_t>(lower); d <= static_cast<ptrdiff_t>(upper); ++d)
+      for (size_t i = b.first_row(d); i < b.last_row(d); ++i)
+        b.diag(d)[i] = m[i][i + d];
+    return b;
+  }
+
+  size_t size() const noexcept { return sz; }
+  size_t lower_bandwidth() const noexcept { return kl; }
+  size_t upper_bandwidth() const noexcept { return ku; }
+
+  bool in_band(size_t i, size_t j) const noexcept { return j + kl >= i && j <= i + ku; }
+
+  // доступ к элементу ленты с контролем
+  T& at(size_t i, size_t j)
+  {
+    if (i >= sz || j >= sz) throw out_of_range("Index out of range");
+    if (!in_band(i, j)) throw out_of_range("Element is outside the band");
+    return diag(static_cast<ptrdiff_t>(j) - static_cast<ptrdiff_t>(i))[i];
+  }
+
+  // значение элемента, вне ленты - ноль
+  T get(size_t i, size_t j) const
+  {
+    if (i >= sz || j >= sz) throw out_of_range("Index out of range");
+    if (!in_band(i, j)) return T();
+    return diag(static_cast<ptrdiff_t>(j) - static_cast<ptrdiff_t>(i))[i];
+  }
+
+  // диагональ d: элемент (i, i + d) под номером i
+  TDynamicVector<T>& diagonal(ptrdiff_t d)
+  {
+    if (d < -static_cast<ptrdiff_t>(kl) || d > static_cast<ptrdiff_t>(ku))
+      throw out_of_range("Diagonal is outside the band");
+    return diag(d);
+  }
+
+  const TDynamicVector<T>& diagonal(ptrdiff_t d) const
+  {
+    if (d < -static_cast<ptrdiff_t>(kl) || d > static_cast<ptrdiff_t>(ku))
+      throw out_of_range("Diagonal is outside the band");
+    return diag(d);
+  }
+
+  TDynamicMatrix<T> to_dense() const
+  {
+    TDynamicMatrix<T> m(sz);
+    for (ptrdiff_t d = -static_cast<ptrdiff_t>(kl); d <= static_cast<ptrdiff_t>(ku); ++d)
+      for (size_t i = first_row(d); i < last_row(d); ++i)
+        m[i][i + d] = diag(d)[i];
+    return m;
+  }
+
+  bool operator==(const TBandMatrix& m) const
+  {
+    if (sz != m.sz) return false;
+    for (size_t i = 0; i < sz; ++i) {
+      size_t j0 = i > std::max(kl, m.kl) ? i - std::max(kl, m.kl) : 0;
+      size_t j1 = std::min(sz, i + std::max(ku, m.ku) + 1);
+      for (size_t j = j0; j < j1; ++j)
+        if (get(i, j) != m.get(i, j)) return false;
+    }
+    return true;
+  }
+
+  bool operator!=(const TBandMatrix& m) const
+  {
+    return !(*this == m);
+  }
+
+  // y = A * x в существующий вектор y; строки обрабатываются блоками,
+  // внутри блока - диагональ за диагональю
+  void multiply_into(const TDynamicVector<T>& x, TDynamicVector<T>& y) const
+  {
+    if (x.size() != sz || y.size() != sz)
+      throw out_of_range("Matrix and vector sizes are incompatible");
+    TMATRIX_SCOPED_OP(TOpKind::Gemv, 2 * sz * (kl + ku + 1), (sz * (kl + ku + 1) + 2 * sz) * sizeof(T));
+    TMATRIX_TRACE("band_gemv");
+
+    const T* px = &x[0];
+    T* py = &y[0];
+    long long blocks = static_cast<long long>((sz + ROW_BLOCK - 1) / ROW_BLOCK);
+#pragma omp parallel for if(blocks >= 16)
+    for (long long blk = 0; blk < blocks; ++blk) {
+      size_t i0 = static_cast<size_t>(blk) * ROW_BLOCK;
+      size_t i1 = std::min(sz, i0 + ROW_BLOCK);
+      std::fill(py + i0, py + i1, T());
+      for (ptrdiff_t d = -static_cast<ptrdiff_t>(kl); d <= static_cast<ptrdiff_t>(ku); ++d) {
+        const T* a = &diag(d)[0];
+        size_t lo = std::max(i0, first_row(d)), hi = std::min(i1, last_row(d));
+        for (size_t i = lo; i < hi; ++i)
+          py[i] += a[i] * px[i + d];
+      }
+    }
+  }
+
+  TDynamicVector<T> operator*(const TDynamicVector<T>& x) const
+  {
+    TDynamicVector<T> y(sz);
+    multiply_into(x, y);
+    return y;
+  }
+
+  TBandMatrix operator*(T val) const
+  {
+    TBandMatrix result(*this);
+    for (size_t d = 0; d < diags.size(); ++d) {
+      T* r = &result.diags[d][0];
+      for (size_t i = 0; i < sz; ++i)
+        r[i] *= val;
+    }
+    return result;
+  }
+
+  // сумма и разность: лента результата - объединение лент
+  TBandMatrix operator+(const TBandMatrix& m) const
+  {
+    return combine(m, T(1));
+  }
+
+  TBandMatrix operator-(const TBandMatrix& m) const
+  {
+    return combine(m, T(-1));
+  }
+
+  // произведение лент: ширины складываются (не больше n - 1),
+  // c(i, i + d1 + d2) += a(i, i + d1) * b(i + d1, i + d1 + d2)
+  TBandMatrix operator*(const TBandMatrix& m) const
+  {
+    if (sz != m.sz) throw out_of_range("Matrices have different sizes");
+    TBandMatrix result(sz, std::min(sz - 1, kl + m.kl), std::min(sz - 1, ku + m.ku));
+    TMATRIX_SCOPED_OP(TOpKind::Gemm, 2 * sz * (kl + ku + 1) * (m.kl + m.ku + 1), 0);
+    TMATRIX_TRACE("band_gemm");
+
+    ptrdiff_t n = static_cast<ptrdiff_t>(sz);
+    for (ptrdiff_t d1 = -static_cast<ptrdiff_t>(kl); d1 <= static_cast<ptrdiff_t>(ku); ++d1) {
+      const T* a = &diag(d1)[0];
+      for (ptrdiff_t d2 = -static_cast<ptrdiff_t>(m.kl); d2 <= static_cast<ptrdiff_t>(m.ku); ++d2) {
+        ptrdiff_t d = d1 + d2;
+        if (d <= -n || d >= n) continue;
+        const T* b = &m.diag(d2)[0];
+        T* c = &result.diag(d)[0];
+        ptrdiff_t lo = std::max({ ptrdiff_t(0), -d1, -d });
+        ptrdiff_t hi = std::min({ n, n - d1, n - d });
+        for (ptrdiff_t i = lo; i < hi; ++i)
+          c[i] += a[i] * b[i + d1];
+      }
+    }
+    return result;
+  }
+
+private:
+  TBandMatrix combine(const TBandMatrix& m, T sign) const
+  {
+    if (sz != m.sz) throw out_of_range("Matrices have different sizes");
+    TBandMatrix result(sz, std::max(kl, m.kl), std::max(ku, m.ku));
+    for (ptrdiff_t d = -static_cast<ptrdiff_t>(kl); d <= static_cast<ptrdiff_t>(ku); ++d)
+      std::copy(&diag(d)[0], &diag(d)[0] + sz, &result.diag(d)[0]);
+    for (ptrdiff_t d = -static_cast<ptrdiff_t>(m.kl); d <= static_cast<ptrdiff_t>(m.ku); ++d) {
+      const T* b = &m.diag(d)[0];
+      T* c = &result.diag(d)[0];
+      for (size_t i = 0; i < sz; ++i)
+        c[i] += sign * b[i];
+    }
+    return result;
+  }
+};
+
+// Трёхдиагональная матрица: лента с kl = ku = 1 и решением методом
+// прогонки (Томаса) за O(n)
+template<typename T>
+class TTridiagonalMatrix : public TBandMatrix<T>
+{
+  using TBandMatrix<T>::sz;
+  using TBandMatrix<T>::diag;
+
+public:
+  explicit TTridiagonalMatrix(size_t n) : TBandMatrix<T>(n, 1, 1) {}
+
+  // поддиагональ: элемент (i, i - 1) под номером i
+  TDynamicVector<T>& lower_diagonal() { return diag(-1); }
+  const TDynamicVector<T>& lower_diagonal() const { return diag(-1); }
+  TDynamicVector<T>& main_diagonal() { return diag(0); }
+  const TDynamicVector<T>& main_diagonal() const { return diag(0); }
+  // наддиагональ: элемент (i, i + 1) под номером i
+  TDynamicVector<T>& upper_diagonal() { return diag(1); }
+  const TDynamicVector<T>& upper_diagonal() const { return diag(1); }
+
+  // решение A x = d прогонкой без выбора ведущего элемента: устойчиво
+  // для матриц с диагональным преобладанием и положительно определённых;
+  // при нулевом знаменателе бросает invalid_argument
+  TDynamicVector<T> solve(const TDynamicVector<T>& d) const
+  {
+    TDynamicVector<T> x(d);
+    solve_into(x, x);
+    return x;
+  }
+
+  // то же в существующий вектор x (может совпадать с d); прогоночные
+  // коэффициенты хранятся в буфере потока, повторные решения не выделяют память
+  void solve_into(const TDynamicVector<T>& d, TDynamicVector<T>& x) const
+  {
+    if (d.size() != sz || x.size() != sz) throw out_of_range("Matrix and vector sizes are incompatible");
+    TMATRIX_SCOPED_OP(TOpKind::Gemv, 8 * sz, 5 * sz * sizeof(T));
+    TMATRIX_TRACE("thomas");
+    if (&d != &x) std::copy(&d[0], &d[0] + sz, &x[0]);
+    const T* a = &diag(-1)[0];
+    const T* b = &diag(0)[0];
+    const T* c = &diag(1)[0];
+    T* px = &x[0];
+    T* cp = semiring_detail::workspace<T>(sz);
+    // одно деление на строку: деления стоят в цепочке зависимостей
+    T m = b[0];
+    for (size_t i = 0;; ++i) {
+      if (m == T()) throw invalid_argument("Zero pivot in tridiagonal solve");
+      T inv = T(1) / m;
+      cp[i] = c[i] * inv;
+      px[i] *= inv;
+      if (i + 1 == sz) break;
+      m = b[i + 1] - a[i + 1] * cp[i];
+      px[i + 1] -= a[i + 1] * px[i];
+    }
+    for (size_t i = sz - 1; i-- > 0;)
+      px[i] -= cp[i] * px[i + 1];
+  }
+};
+
+// LU-разложение ленточной матрицы без перестановок: множители L и U
+// остаются в пределах исходной ленты, разложение O(n kl ku), решение
+// O(n (kl + ku)). Предназначено для матриц с диагональным преобладанием
+// и положительно определённых (типичные сеточные задачи); при нулевом
+// ведущем элементе бросает invalid_argument
+template<typename T>
+class TBandLU
+{
+  TBandMatrix<T> lu;
+  size_t kl, ku;
+  TDynamicVector<T*> diags;   // diags[d + kl] - диагональ d множителей
+
+  T& ref(size_t i, size_t j) { return diags[j + kl - i][i]; }
+  T ref(size_t i, size_t j) const { return diags[j + kl - i][i]; }
+
+public:
+  explicit TBandLU(const TBandMatrix<T>& a)
+    : lu(a), kl(a.lower_bandwidth()), ku(a.upper_bandwidth()), diags(kl + ku + 1)
+  {
+    size_t n = lu.size();
+    for (size_t d = 0; d < diags.size(); ++d)
+      diags[d] = &lu.diagonal(static_cast<ptrdiff_t>(d) - static_cast<ptrdiff_t>(kl))[0];
+    TMATRIX_SCOPED_OP(TOpKind::Gemm, 2 * n * kl * ku + n * kl, 0);
+    TMATRIX_TRACE("band_lu");
+    for (size_t k = 0; k < n; ++k) {
+      T pivot = ref(k, k);
+      if (pivot == T()) throw invalid_argument("Zero pivot in banded LU");
+      size_t i1 = std::min(n, k + kl + 1), j1 = std::min(n, k + ku + 1);
+      for (size_t i = k + 1; i < i1; ++i) {
+        T l = ref(i, k) /= pivot;
+        if (l == T()) continue;
+        for (size_t j = k + 1; j < j1; ++j)
+          ref(i, j) -= l * ref(k, j);
+      }
+    }
+  }
+
+  TBandLU(const TBandLU&) = delete;
+  TBandLU& operator=(const TBandLU&) = delete;
+
+  size_t size() const noexcept { return lu.size(); }
+
+  // совмещённые множители: ниже диагонали - L (единичная диагональ), остальное - U
+  const TBandMatrix<T>& factors() const noexcept { return lu; }
+
+  TDynamicVector<T> solve(const TDynamicVector<T>& b) const
+  {
+    TDynamicVector<T> x(b);
+    solve_into(x, x);
+    return x;
+  }
+
+  // решение в существующий вектор x (может совпадать с b)
+  void solve_into(const TDynamicVector<T>& b, TDynamicVector<T>& x) const
+  {
+    size_t n = lu.size();
+    if (b.size() != n || x.size() != n) throw out_of_range("Matrix and vector sizes are incompatible");
+    TMATRIX_SCOPED_OP(TOpKind::Gemv, 2 * n * (kl + ku + 1), 0);
+    TMATRIX_TRACE("band_lu_solve");
+    if (&b != &x) std::copy(&b[0], &b[0] + n, &x[0]);
+    T* px = &x[0];
+    for (size_t i = 0; i < n; ++i) {
+      T s = px[i];
+      for (size_t j = i > kl ? i - kl : 0; j < i; ++j)
+        s -= ref(i, j) * px[j];
+      px[i] = s;
+    }
+    for (size_t i = n; i-- > 0;) {
+      T s = px[i];
+      size_t j1 = std::min(n, i + ku + 1);
+      for (size_t j = i + 1; j < j1; ++j)
+        s -= ref(i, j) * px[j];
+      px[i] = s / ref(i, i);
+    }
+  }
+};
+
+// Оператор для итерационных методов (tsolvers.h)
+template<typename T>
+auto make_operator(const TBandMatrix<T>& a)
+{
+  return [&a](const TDynamicVector<T>& x, TDynamicVector<T>& y) {
+    a.multiply_into(x, y);
+  };
+}
+
+#endif
@@ -0,0 +1,185 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Пакетное умножение большого числа малых матриц
+
+#ifndef __TBatch_H__
+#define __TBatch_H__
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "tmatrix.h"
+
+// Пакет из count квадратных матриц n x n с чередованием по пакету:
+// матрицы разбиты на группы по BATCH_LANES, внутри группы элемент (i, j)
+// всех матриц лежит подряд, поэтому самый внутренний цикл ядра идёт
+// по матрицам пакета и векторизуется при любом n. Данные пакета не
+// ограничены MAX_VECTOR_SIZE: пакет из миллионов малых матриц легко
+// превышает его, поэтому проверяется лишь переполнение размера
+template<typename T>
+class TMatrixBatch
+{
+public:
+  static constexpr size_t BATCH_LANES = 8;
+
+protected:
+  size_t sz;
+  size_t cnt;
+  size_t groups;
+  std::vector<T> data;
+
+  static size_t storage_size(size_t n, size_t count)
+  {
+    if (n == 0 || count == 0) throw out_of_range("Batch size should be greater than zero");
+    if (n > MAX_MATRIX_SIZE) throw out_of_range("Matrix size should be less than the maximum");
+    size_t g = count / BATCH_LANES + (count % BATCH_LANES != 0);
+    size_t perGroup = n * n * BATCH_LANES;
+    if (g > std::numeric_limits<size_t>::max() / sizeof(T) / perGroup)
+      throw out_of_range("Batch is too large");
+    return g * perGroup;
+  }
+
+  size_t index(size_t b, size_t i, size_t j) const
+  {
+    return (((b / BATCH_LANES) * sz + i) * sz + j) * BATCH_LANES + b % BATCH_LANES;
+  }
+
+public:
+  TMatrixBatch(size_t n, size_t count)
+    : sz(n), cnt(count), groups(count / BATCH_LANES + (count % BATCH_LANES != 0)),
+      data(storage_size(n, count))
+  {
+  }
+
+  size_t size() const noexcept { return sz; }
+  size_t count() const noexcept { return cnt; }
+
+  // элемент (i, j) матрицы b
+  T& operator()(size_t b, size_t i, size_t j) { return data[index(b, i, j)]; }
+  const T& operator()(size_t b, size_t i, size_t j) const { return data[index(b, i, j)]; }
+
+  // начало группы g (BATCH_LANES чередующихся матриц)
+  T* group(size_t g) { return &data[g * sz * sz * BATCH_LANES]; }
+  const T* group(size_t g) const { return &data[g * sz * sz * BATCH_LANES]; }
+  size_t group_count() const noexcept { return groups; }
+
+  void set(size_t b, const TDynamicMatrix<T>& m)
+  {
+    if (b >= cnt) throw out_of_range("Index out of range");
+    if (m.size() != sz) throw out_of_range("Matrix sizes are incompatible");
+    for (size_t i = 0; i < sz; ++i)
+      for (size_t j = 0; j < sz; ++j)
+        (*this)(b, i, j) = m[i][j];
+  }
+
+  TDynamicMatrix<T> get(size_t b) const
+  {
+    if (b >= cnt) throw out_of_range("Index out of range");
+    TDynamicMatrix<T> m(sz);
+    for (size_t i = 0; i < sz; ++i)
+      for (size_t j = 0; j < sz; ++j)
+        m[i][j] = (*this)(b, i, j);
+    return m;
+  }
+
+  // загрузка из массива матриц, хранящихся построчно с шагом stride
+  void load(const T* src, size_t stride)
+  {
+    for (size_t b = 0; b < cnt; ++b)
+      for (size_t i = 0; i < sz; ++i)
+        for (size_t j = 0; j < sz; ++j)
+          (*this)(b, i, j) = src[b * stride + i * sz + j];
+  }
+
+  void store(T* dst, size_t stride) const
+  {
+    for (size_t b = 0; b < cnt; ++b)
+      for (size_t i = 0; i < sz; ++i)
+        for (size_t j = 0; j < sz; ++j)
+          dst[b * stride + i * sz + j] = (*this)(b, i, j);
+  }
+};
+
+namespace batch_detail
+{
+  // пересекаются ли отрезки памяти [p, p + lp) и [q, q + lq)
+  template<typename T>
+  bool overlap(const T* p, size_t lp, const T* q, size_t lq)
+  {
+    std::less<const T*> less;
+    return less(p, q + lq) && less(q, p + lp);
+  }
+}
+
+// c[b] = a[b] * b[b] для всех матриц пакета; группы
+// обрабатываются параллельно, внутри группы - векторно по пакету.
+// c не должен совпадать с a или b (иначе invalid_argument)
+template<typename T>
+void batch_multiply(const TMatrixBatch<T>& a, const TMatrixBatch<T>& b, TMatrixBatch<T>& c)
+{
+  const size_t L = TMatrixBatch<T>::BATCH_LANES;
+  size_t n = a.size();
+  if (b.size() != n || c.size() != n || b.count() != a.count() || c.count() != a.count())
+    throw out_of_range("Batches have different shapes");
+  if (&c == &a || &c == &b)
+    throw invalid_argument("Result batch must differ from the operands");
+  TMATRIX_TRACE("batch_gemm");
+
+#pragma omp parallel for if(a.group_count() >= 4)
+  for (long long g = 0; g < static_cast<long long>(a.group_count()); ++g) {
+    const T* pa = a.group(static_cast<size_t>(g));
+    const T* pb = b.group(static_cast<size_t>(g));
+    T* pc = c.group(static_cast<size_t>(g));
+    std::fill(pc, pc + n * n * L, T());
+    for (size_t i = 0; i < n; ++i)
+      for (size_t k = 0; k < n; ++k) {
+        const T* aik = pa + (i * n + k) * L;
+        for (size_t j = 0; j < n; ++j) {
+          const T* bkj = pb + (k * n + j) * L;
+          T* cij = pc + (i * n + j) * L;
+          for (size_t l = 0; l < L; ++l)
+            cij[l] += aik[l] * bkj[l];
+        }
+      }
+  }
+}
+
+// Пакетное умножение матриц n x n, хранящихся построчно подряд с шагами
+// strideA, strideB, strideC между соседними матрицами; без перепаковки,
+// внутренний цикл векторизуется по строке, пакет делится между потоками.
+// Память всего пакета c (от первой до конца последней матрицы) не должна
+// пересекаться с памятью пакетов a и b (иначе invalid_argument)
+template<typename T>
+void gemm_strided_batched(const T* a, size_t strideA, const T* b, size_t strideB,
+  T* c, size_t strideC, size_t n, size_t count)
+{
+  if (n == 0 || n > MAX_MATRIX_SIZE) throw out_of_range("Matrix size is out of range");
+  if (count == 0) return;
+  size_t last = n * n;
+  if (batch_detail::overlap<T>(c, (count - 1) * strideC + last, a, (count - 1) * strideA + last) ||
+      batch_detail::overlap<T>(c, (count - 1) * strideC + last, b, (count - 1) * strideB + last))
+    throw invalid_argument("Result batch must not overlap the operands");
+
+#pragma omp parallel for if(count >= 16)
+  for (long long bb = 0; bb < static_cast<long long>(count); ++bb) {
+    const T* pa = a + static_cast<size_t>(bb) * strideA;
+    const T* pb = b + static_cast<size_t>(bb) * strideB;
+    T* pc = c + static_cast<size_t>(bb) * strideC;
+    for (size_t i = 0; i < n; ++i) {
+      T* ci = pc + i * n;
+      std::fill(ci, ci + n, T());
+      for (size_t k = 0; k < n; ++k) {
+        T aik = pa[i * n + k];
+        const T* bk = pb + k * n;
+        for (size_t j = 0; j < n; ++j)
+          ci[j] += aik * bk[j];
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,311 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Битовая матрица над GF(2)
+
+#ifndef __TBitMatrix_H__
+#define __TBitMatrix_H__
+
+#include <cstdint>
+#include <bitset>
+#include <algorithm>
+#include <stdexcept>
+#include "tmatrix.h"
+
+inline size_t popcount64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<size_t>(__builtin_popcountll(x));
+#else
+  return std::bitset<64>(x).count();
+#endif
+}
+
+// Квадратная булева матрица, упакованная по 64 элемента в слово;
+// строки хранятся подряд, по words слов на строку
+class TBitMatrix
+{
+protected:
+  size_t sz;
+  size_t words;
+  uint64_t* pMem;
+
+  static constexpr size_t TABLE_BITS = 8; // разрядность таблиц метода четырёх русских
+
+  uint64_t* row(size_t i) { return pMem + i * words; }
+  const uint64_t* row(size_t i) const { return pMem + i * words; }
+
+  // Произведение методом четырёх русских: для каждой группы из 8 строк b
+  // строятся все 256 комбинаций, строка результата набирается по байтам
+  // строки a; combine - операция сложения строк (xor для GF(2), or для булевой)
+  template<typename Combine>
+  TBitMatrix multiply(const TBitMatrix& m, Combine combine) const
+  {
+    if (sz != m.sz) throw out_of_range("Matrices have different sizes");
+    TBitMatrix result(sz);
+    uint64_t* table = new uint64_t[(size_t(1) << TABLE_BITS) * words];
+    for (size_t k0 = 0; k0 < sz; k0 += TABLE_BITS) {
+      size_t kk = std::min(TABLE_BITS, sz - k0);
+      std::fill(table, table + words, uint64_t(0));
+      for (size_t mask = 1; mask < (size_t(1) << kk); ++mask) {
+        size_t low = 0;
+        while (!((mask >> low) & 1)) ++low;
+        const uint64_t* prev = table + (mask & (mask - 1)) * words;
+        const uint64_t* src = m.row(k0 + low);
+        uint64_t* dst = table + mask * words;
+        for (size_t w = 0; w < words; ++w)
+          dst[w] = combine(prev[w], src[w]);
+      }
+      for (size_t i = 0; i < sz; ++i) {
+        size_t mask = static_cast<size_t>((row(i)[k0 / 64] >> (k0 % 64)) & ((uint64_t(1) << kk) - 1));
+        if (mask == 0) continue;
+        const uint64_t* src = table + mask * words;
+        uint64_t* dst = result.row(i);
+        for (size_t w = 0; w < words; ++w)
+          dst[w] = combine(dst[w], src[w]);
+      }
+    }
+    delete[] table;
+    return result;
+  }
+
+public:
+  TBitMatrix(size_t s = 1) : sz(s)
+  {
+    if (sz == 0) throw out_of_range("Matrix size should be greater than zero");
+    if (sz > MAX_VECTOR_SIZE) throw out_of_range("Matrix size should be less than the maximum");
+    words = (sz + 63) / 64;
+    pMem = new uint64_t[sz * words]();
+  }
+
+  TBitMatrix(const TDynamicMatrix<bool>& m) : TBitMatrix(m.size())
+  {
+    for (size_t i = 0; i < sz; ++i)
+      for (size_t j = 0; j < sz; ++j)
+        if (m[i][j]) set(i, j, true);
+  }
+
+  TBitMatrix(const TBitMatrix& m) : sz(m.sz), words(m.words)
+  {
+    pMem = new uint64_t[sz * words];
+    std::copy(m.pMem, m.pMem + sz * words, pMem);
+  }
+
+  TBitMatrix(TBitMatrix&& m) noexcept : sz(m.sz), words(m.words), pMem(m.pMem)
+  {
+    m.sz = 0;
+    m.words = 0;
+    m.pMem = nullptr;
+  }
+
+  ~TBitMatrix()
+  {
+    delete[] pMem;
+  }
+
+  TBitMatrix& operator=(const TBitMatrix& m)
+  {
+    if (this == &m) return *this;
+    TBitMatrix tmp(m);
+    swap(*this, tmp);
+    return *this;
+  }
+
+  TBitMatrix& operator=(TBitMatrix&& m) noexcept
+  {
+    swap(*this, m);
+    return *this;
+  }
+
+  size_t size() const noexcept { return sz; }
+
+  // доступ к элементам
+  bool get(size_t i, size_t j) const
+  {
+    return (row(i)[j / 64] >> (j % 64)) & 1;
+  }
+
+  void set(size_t i, size_t j, bool val)
+  {
+    uint64_t bit = uint64_t(1) << (j % 64);
+    if (val) row(i)[j / 64] |= bit;
+    else row(i)[j / 64] &= ~bit;
+  }
+
+  bool at(size_t i, size_t j) const
+  {
+    if (i >= sz || j >= sz) throw out_of_range("Index out of range");
+    return get(i, j);
+  }
+
+  TDynamicMatrix<bool> to_matrix() const
+  {
+    TDynamicMatrix<bool> m(sz);
+    for (size_t i = 0; i < sz; ++i)
+      for (size_t j = 0; j < sz; ++j)
+        m[i][j] = get(i, j);
+    return m;
+  }
+
+  // число единиц в строке i. Счётчики строк 32-битные (строка короче
+  // 2^32 бит): GCC 12 с AVX512-VPOPCNTDQ неверно векторизует сумму
+  // popcount, расширяемую до 64 бит
+  size_t row_popcount(size_t i) const
+  {
+    uint32_t cnt = 0;
+    for (size_t w = 0; w < words; ++w)
+      cnt += static_cast<uint32_t>(popcount64(row(i)[w]));
+    return cnt;
+  }
+
+  // число общих единиц строки i этой матрицы и строки j матрицы m;
+  // скалярное произведение над GF(2) - чётность этого числа
+  size_t row_dot(size_t i, const TBitMatrix& m, size_t j) const
+  {
+    if (sz != m.sz) throw out_of_range("Matrices have different sizes");
+    uint32_t cnt = 0;
+    const uint64_t* a = row(i);
+    const uint64_t* b = m.row(j);
+    for (size_t w = 0; w < words; ++w)
+      cnt += static_cast<uint32_t>(popcount64(a[w] & b[w]));
+    return cnt;
+  }
+
+  // сравнение
+  bool operator==(const TBitMatrix& m) const noexcept
+  {
+    return sz == m.sz && std::equal(pMem, pMem + sz * words, m.pMem);
+  }
+
+  bool operator!=(const TBitMatrix& m) const noexcept
+  {
+    return !(*this == m);
+  }
+
+  // сложение над GF(2)
+  TBitMatrix operator^(const TBitMatrix& m) const
+  {
+    if (sz != m.sz) throw out_of_range("Matrices have different sizes");
+    TBitMatrix result(*this);
+    for (size_t w = 0; w < sz * words; ++w)
+      result.pMem[w] ^= m.pMem[w];
+    return result;
+  }
+
+  // поэлементное И
+  TBitMatrix operator&(const TBitMatrix& m) const
+  {
+    if (sz != m.sz) throw out_of_range("Matrices have different sizes");
+    TBitMatrix result(*this);
+    for (size_t w = 0; w < sz * words; ++w)
+      result.pMem[w] &= m.pMem[w];
+    return result;
+  }
+
+  // произведение над GF(2) (and, xor)
+  TBitMatrix operator*(const TBitMatrix& m) const
+  {
+    return multiply(m, [](uint64_t x, uint64_t y) { return x ^ y; });
+  }
+
+  // булево произведение (and, or)
+  TBitMatrix bool_multiply(const TBitMatrix& m) const
+  {
+    return multiply(m, [](uint64_t x, uint64_t y) { return x | y; });
+  }
+
+  // Приведение к ступенчатому виду над GF(2) методом четырёх русских (M4RI):
+  // в блоке из TABLE_BITS столбцов ищутся ведущие строки, по ним строится
+  // таблица всех комбинаций, после чего каждая строка обнуляется в ведущих
+  // столбцах блока одной операцией xor. Возвращает ранг
+  size_t gauss_gf2()
+  {
+    uint64_t* table = new uint64_t[(size_t(1) << TABLE_BITS) * words];
+    size_t pivotCols[TABLE_BITS];
+    size_t r = 0;
+    for (size_t col = 0; col < sz && r < sz; col += TABLE_BITS) {
+      size_t kk = std::min(TABLE_BITS, sz - col);
+      size_t found = 0;
+      for (size_t c = col; c < col + kk && r + found < sz; ++c) {
+        for (size_t p = r + found; p < sz; ++p) {
+          for (size_t f = 0; f < found; ++f)
+            if (get(p, pivotCols[f])) xor_rows(p, r + f);
+          if (!get(p, c)) continue;
+          swap_rows(p, r + found);
+          for (size_t f = 0; f < found; ++f)
+            if (get(r + f, c)) xor_rows(r + f, r + found);
+          pivotCols[found++] = c;
+          break;
+        }
+      }
+      if (found == 0) continue;
+
+      std::fill(table, table + words, uint64_t(0));
+      for (size_t mask = 1; mask < (size_t(1) << found); ++mask) {
+        size_t low = 0;
+        while (!((mask >> low) & 1)) ++low;
+        const uint64_t* prev = table + (mask & (mask - 1)) * words;
+        const uint64_t* src = row(r + low);
+        uint64_t* dst = table + mask * words;
+        for (size_t w = 0; w < words; ++w)
+          dst[w] = prev[w] ^ src[w];
+      }
+      for (size_t i = 0; i < sz; ++i) {
+        if (i >= r && i < r + found) continue;
+        size_t mask = 0;
+        for (size_t f = 0; f < found; ++f)
+          mask |= size_t(get(i, pivotCols[f])) << f;
+        if (mask == 0) continue;
+        const uint64_t* src = table + mask * words;
+        uint64_t* dst = row(i);
+        for (size_t w = 0; w < words; ++w)
+          dst[w] ^= src[w];
+      }
+      r += found;
+    }
+    delete[] table;
+    return r;
+  }
+
+  // ранг над GF(2)
+  size_t rank() const
+  {
+    TBitMatrix tmp(*this);
+    return tmp.gauss_gf2();
+  }
+
+  void xor_rows(size_t dst, size_t src)
+  {
+    uint64_t* d = row(dst);
+    const uint64_t* s = row(src);
+    for (size_t w = 0; w < words; ++w)
+      d[w] ^= s[w];
+  }
+
+  void swap_rows(size_t i, size_t j)
+  {
+    if (i != j)
+      std::swap_ranges(row(i), row(i) + words, row(j));
+  }
+
+  friend void swap(TBitMatrix& lhs, TBitMatrix& rhs) noexcept
+  {
+    std::swap(lhs.sz, rhs.sz);
+    std::swap(lhs.words, rhs.words);
+    std::swap(lhs.pMem, rhs.pMem);
+  }
+
+  // ввод/вывод
+  friend ostream& operator<<(ostream& ostr, const TBitMatrix& m)
+  {
+    for (size_t i = 0; i < m.sz; ++i) {
+      for (size_t j = 0; j < m.sz; ++j)
+        ostr << (m.get(i, j) ? '1' : '0');
+      ostr << '\n';
+    }
+    return ostr;
+  }
+};
+
+#endif
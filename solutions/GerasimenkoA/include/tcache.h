@@ -0,0 +1,321 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// LRU-кэш результатов произведений с ограничением по памяти
+
+#ifndef __TCache_H__
+#define __TCache_H__
+
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "tmatrix.h"
+
+// Вид кэшируемого произведения
+enum class TProductKind
+{
+  Gemm = 0,      // A * B
+  Gemv = 1,      // A * x, к виду добавляется номер режима суммирования
+  GemvLeft = 8   // x^T * A
+};
+
+// Ключ: вид операции, размер и хеши содержимого операндов (см. hash())
+struct TProductKey
+{
+  uint32_t kind;
+  size_t size;
+  uint64_t lhs, rhs;
+
+  bool operator==(const TProductKey& k) const
+  {
+    return kind == k.kind && size == k.size && lhs == k.lhs && rhs == k.rhs;
+  }
+};
+
+struct TProductKeyHash
+{
+  size_t operator()(const TProductKey& k) const
+  {
+    return static_cast<size_t>(k.lhs * hash_detail::PRIME1 ^ k.rhs * hash_detail::PRIME2 ^ (k.size + k.kind));
+  }
+};
+
+// Статистика кэша для подбора его размера
+struct TCacheStats
+{
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  uint64_t rejected = 0;   // результаты больше всего бюджета
+  size_t entries = 0;
+  size_t bytes = 0;
+};
+
+// Кэш результатов произведений. Ключ - хеши содержимого операндов,
+// поэтому повторное произведение тех же данных находится и для других
+// объектов. Хеш лишь отбирает кандидата: запись хранит копии операндов,
+// и попаданием считается только их совпадение с текущими операндами,
+// так что ни коллизия хешей, ни устаревший хеш (запись по ссылке,
+// полученной до hash()) не вернут чужой результат. Копии матриц-операндов
+// общие для записей с одинаковым содержимым (A при многих x хранится
+// один раз) и входят в бюджет памяти вместе с результатами; проверка
+// попадания стоит одного чтения операндов, поэтому выигрыш велик для
+// A * B и невелик для A * x.
+// При превышении бюджета вытесняются давно не использованные результаты.
+// Установленный кэш (install) проверяют operator* и multiply матрицы,
+// left_multiply и gemv; без установленного кэша проверка стоит одного
+// сравнения указателя. Кэш потокобезопасен, но операнды не должны
+// изменяться другими потоками во время произведения
+template<typename T>
+class TProductCache
+{
+  using TMatrixPtr = std::shared_ptr<const TDynamicMatrix<T>>;
+  using TVectorPtr = std::shared_ptr<const TDynamicVector<T>>;
+
+  struct TEntry
+  {
+    TProductKey key;
+    TMatrixPtr lhs;           // копии операндов для проверки попадания
+    TMatrixPtr rhsMatrix;
+    TVectorPtr rhsVector;
+    bool lhsShared = false;   // копия взята из общего набора по хешу
+    bool rhsShared = false;
+    TMatrixPtr matrix;        // результат
+    TVectorPtr vector;
+    size_t bytes = 0;         // результат и собственные копии операндов
+  };
+
+  // общая копия матрицы-операнда и число ссылающихся на неё записей
+  struct TShared
+  {
+    TMatrixPtr matrix;
+    size_t refs;
+  };
+
+  size_t budget;
+  std::list<TEntry> lru;   // в начале - последние использованные
+  std::unordered_map<TProductKey, typename std::list<TEntry>::iterator, TProductKeyHash> index;
+  std::unordered_map<uint64_t, TShared> operands;   // по хешу содержимого
+  TCacheStats st;
+  mutable std::mutex mutex;
+
+  static std::atomic<TProductCache*>& installed_ref()
+  {
+    static std::atomic<TProductCache*> cache{ nullptr };
+    return cache;
+  }
+
+  static size_t matrix_bytes(const TDynamicMatrix<T>& m) { return m.size() * m.size() * sizeof(T); }
+
+  // копия операнда: общая, если в наборе есть матрица с тем же хешем и
+  // содержимым, иначе новая (общей становится, если хеш свободен)
+  TMatrixPtr acquire(const TDynamicMatrix<T>& m, uint64_t h, bool& shared, size_t& ownBytes)
+  {
+    auto it = operands.find(h);
+    if (it != operands.end() && *it->second.matrix == m) {
+      ++it->second.refs;
+      shared = true;
+      return it->second.matrix;
+    }
+    TMatrixPtr copy = std::make_shared<const TDynamicMatrix<T>>(m);
+    if (it == operands.end()) {
+      operands.emplace(h, TShared{ copy, 1 });
+      st.bytes += matrix_bytes(m);
+      shared = true;
+    }
+    else {
+      ownBytes += matrix_bytes(m);
+      shared = false;
+    }
+    return copy;
+  }
+
+  void release_shared(uint64_t h)
+  {
+    auto it = operands.find(h);
+    if (--it->second.refs == 0) {
+      st.bytes -= matrix_bytes(*it->second.matrix);
+      operands.erase(it);
+    }
+  }
+
+  void release(const TEntry& e)
+  {
+    if (e.lhsShared) release_shared(e.key.lhs);
+    if (e.rhsShared) release_shared(e.key.rhs);
+  }
+
+  void erase(typename std::list<TEntry>::iterator it)
+  {
+    st.bytes -= it->bytes;
+    release(*it);
+    index.erase(it->key);
+    lru.erase(it);
+  }
+
+  TEntry* find(const TProductKey& key)
+  {
+    auto it = index.find(key);
+    if (it == index.end()) return nullptr;
+    return &*it->second;
+  }
+
+  void hit(const TProductKey& key)
+  {
+    ++st.hits;
+    auto it = index.find(key);
+    lru.splice(lru.begin(), lru, it->second);
+  }
+
+  // запись с уже взятыми копиями операндов; прежняя запись с тем же
+  // ключом (не прошедшая проверку операндов) заменяется
+  void store(TEntry e)
+  {
+    while (st.bytes + e.bytes > budget && !lru.empty()) {
+      erase(std::prev(lru.end()));
+      ++st.evictions;
+    }
+    if (st.bytes + e.bytes > budget) {
+      release(e);
+      ++st.rejected;
+      return;
+    }
+    st.bytes += e.bytes;
+    lru.push_front(std::move(e));
+    index[lru.front().key] = lru.begin();
+  }
+
+  void remove(const TProductKey& key)
+  {
+    auto it = index.find(key);
+    if (it != index.end()) erase(it->second);
+  }
+
+  bool reject(size_t bytes)
+  {
+    if (bytes <= budget) return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    ++st.rejected;
+    return true;
+  }
+
+public:
+  explicit TProductCache(size_t budgetBytes) : budget(budgetBytes) {}
+
+  ~TProductCache()
+  {
+    TProductCache* self = this;
+    installed_ref().compare_exchange_strong(self, nullptr);
+  }
+
+  TProductCache(const TProductCache&) = delete;
+  TProductCache& operator=(const TProductCache&) = delete;
+
+  // сделать кэш общим для операций над T (nullptr - отключить);
+  // возвращает ранее установленный
+  static TProductCache* install(TProductCache* cache)
+  {
+    return installed_ref().exchange(cache);
+  }
+
+  static TProductCache* installed() { return installed_ref().load(std::memory_order_acquire); }
+
+  // сохранённое a * b, если операнды записи совпадают с a и b
+  TMatrixPtr find_matrix(const TProductKey& key, const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    TEntry* e = find(key);
+    if (!e || !e->matrix || !(*e->lhs == a) || !(*e->rhsMatrix == b)) {
+      ++st.misses;
+      return nullptr;
+    }
+    hit(key);
+    return e->matrix;
+  }
+
+  // сохранённое произведение a и x того вида, что задан ключом
+  TVectorPtr find_vector(const TProductKey& key, const TDynamicMatrix<T>& a, const TDynamicVector<T>& x)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    TEntry* e = find(key);
+    if (!e || !e->vector || !(*e->lhs == a) || !(*e->rhsVector == x)) {
+      ++st.misses;
+      return nullptr;
+    }
+    hit(key);
+    return e->vector;
+  }
+
+  // копии результата и операндов сохраняются, если помещаются в бюджет
+  void insert(const TProductKey& key, const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b,
+    const TDynamicMatrix<T>& m)
+  {
+    size_t bytes = matrix_bytes(m);
+    if (reject(bytes)) return;
+    TEntry e;
+    e.key = key;
+    e.bytes = bytes;
+    e.matrix = std::make_shared<const TDynamicMatrix<T>>(m);
+    std::lock_guard<std::mutex> lock(mutex);
+    remove(key);
+    e.lhs = acquire(a, key.lhs, e.lhsShared, e.bytes);
+    e.rhsMatrix = acquire(b, key.rhs, e.rhsShared, e.bytes);
+    store(std::move(e));
+  }
+
+  void insert(const TProductKey& key, const TDynamicMatrix<T>& a, const TDynamicVector<T>& x,
+    const TDynamicVector<T>& v)
+  {
+    size_t bytes = (v.size() + x.size()) * sizeof(T);
+    if (reject(bytes)) return;
+    TEntry e;
+    e.key = key;
+    e.bytes = bytes;
+    e.vector = std::make_shared<const TDynamicVector<T>>(v);
+    e.rhsVector = std::make_shared<const TDynamicVector<T>>(x);
+    std::lock_guard<std::mutex> lock(mutex);
+    remove(key);
+    e.lhs = acquire(a, key.lhs, e.lhsShared, e.bytes);
+    store(std::move(e));
+  }
+
+  TCacheStats stats() const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    TCacheStats s = st;
+    s.entries = lru.size();
+    return s;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    lru.clear();
+    index.clear();
+    operands.clear();
+    st = TCacheStats();
+  }
+
+  static TProductKey gemm_key(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+  {
+    return TProductKey{ static_cast<uint32_t>(TProductKind::Gemm), a.size(), a.hash(), b.hash() };
+  }
+
+  static TProductKey gemv_key(const TDynamicMatrix<T>& a, const TDynamicVector<T>& x, TSumMode mode = TSumMode::Fast)
+  {
+    return TProductKey{ static_cast<uint32_t>(TProductKind::Gemv) + static_cast<uint32_t>(mode),
+      a.size(), a.hash(), x.hash() };
+  }
+
+  static TProductKey left_gemv_key(const TDynamicMatrix<T>& a, const TDynamicVector<T>& x)
+  {
+    return TProductKey{ static_cast<uint32_t>(TProductKind::GemvLeft), a.size(), a.hash(), x.hash() };
+  }
+};
+
+#endif
@@ -0,0 +1,317 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Разложения LU и Холецкого с обновлениями малого ранга
+
+#ifndef __TFactor_H__
+#define __TFactor_H__
+
+#include <cmath>
+#include <stdexcept>
+#include "tmatrix.h"
+#include "tlinalg.h"
+
+// LU-разложение с выбором ведущего элемента по столбцу: P A = L U.
+// L (единичная диагональ) и U хранятся в одной матрице. Обновление
+// A + alpha x y^T пересчитывает множители за O(n^2) вместо O(n^3)
+// нового разложения, но без перестановок строк, поэтому при близком
+// к нулю ведущем элементе разумнее разложить матрицу заново
+template<typename T>
+class TLU
+{
+  TDynamicMatrix<T> lu;
+  TDynamicVector<size_t> perm;   // строка i разложения - строка perm[i] матрицы A
+
+public:
+  explicit TLU(const TDynamicMatrix<T>& a) : lu(a), perm(a.size())
+  {
+    TMATRIX_TRACE("lu");
+    size_t n = lu.size();
+    TMATRIX_SCOPED_OP(TOpKind::Gemm, 2 * n * n * n / 3, n * n * sizeof(T));
+    for (size_t i = 0; i < n; ++i)
+      perm[i] = i;
+    for (size_t k = 0; k < n; ++k) {
+      size_t p = k;
+      for (size_t i = k + 1; i < n; ++i)
+        if (std::abs(lu[i][k]) > std::abs(lu[p][k])) p = i;
+      if (lu[p][k] == T()) throw invalid_argument("Matrix is singular");
+      if (p != k) {
+        swap(lu[p], lu[k]);
+        std::swap(perm[p], perm[k]);
+      }
+      const T* uk = &lu[k][0];
+      for (size_t i = k + 1; i < n; ++i) {
+        T* li = &lu[i][0];
+        T m = li[k] /= uk[k];
+        for (size_t j = k + 1; j < n; ++j)
+          li[j] -= m * uk[j];
+      }
+    }
+  }
+
+  size_t size() const noexcept { return lu.size(); }
+
+  // совмещённые множители: строго ниже диагонали - L, остальное - U
+  const TDynamicMatrix<T>& factors() const noexcept { return lu; }
+  const TDynamicVector<size_t>& permutation() const noexcept { return perm; }
+
+  // решение A x = b
+  TDynamicVector<T> solve(const TDynamicVector<T>& b) const
+  {
+    size_t n = lu.size();
+    if (b.size() != n) throw out_of_range("Matrix and vector sizes are incompatible");
+    TMATRIX_SCOPED_OP(TOpKind::Gemv, 2 * n * n, n * n * sizeof(T));
+    TDynamicVector<T> result(n);
+    T* x = &result[0];
+    for (size_t i = 0; i < n; ++i) {
+      const T* li = &lu[i][0];
+      T s = b[perm[i]];
+      for (size_t j = 0; j < i; ++j)
+        s -= li[j] * x[j];
+      x[i] = s;
+    }
+    for (size_t i = n; i-- > 0;) {
+      const T* ui = &lu[i][0];
+      T s = x[i];
+      for (size_t j = i + 1; j < n; ++j)
+        s -= ui[j] * x[j];
+      x[i] = s / ui[i];
+    }
+    return result;
+  }
+
+  // разложение A + alpha * x * y^T (алгоритм Беннета): на шаге k
+  // обновляются строка k множителя U и столбец k множителя L, а остаток
+  // обновления переходит на подматрицу; O(n^2). При нулевом ведущем
+  // элементе бросает invalid_argument, разложение остаётся испорченным
+  void update(T alpha, const TDynamicVector<T>& x, const TDynamicVector<T>& y)
+  {
+    size_t n = lu.size();
+    if (x.size() != n || y.size() != n)
+      throw out_of_range("Matrix and vector sizes are incompatible");
+    TMATRIX_SCOPED_OP(TOpKind::Gemv, 6 * n * n, n * n * sizeof(T));
+    TMATRIX_TRACE("lu_update");
+
+    TDynamicVector<T> uv(n), vv(y);   // P x и y, уменьшаемые по ходу
+    T* u = &uv[0];
+    T* v = &vv[0];
+    for (size_t i = 0; i < n; ++i)
+      u[i] = x[perm[i]];
+    for (size_t k = 0; k < n; ++k) {
+      T* uk = &lu[k][0];
+      T ukk = uk[k];
+      T pivot = ukk + alpha * u[k] * v[k];
+      if (pivot == T()) throw invalid_argument("Zero pivot in LU update");
+      T au = alpha * u[k], vs = v[k] / ukk;
+      for (size_t j = k + 1; j < n; ++j) {
+        T old = uk[j];
+        uk[j] = old + au * v[j];
+        v[j] -= vs * old;
+      }
+      T av = alpha * v[k];
+      for (size_t i = k + 1; i < n; ++i) {
+        T& lik = lu[i][k];
+        T old = lik;
+        lik = (old * ukk + av * u[i]) / pivot;
+        u[i] -= u[k] * old;
+      }
+      uk[k] = pivot;
+      alpha = alpha * ukk / pivot;
+    }
+  }
+
+  // обновление ранга k: A + u * v^T по одному столбцу блоков
+  void update(const TColumnBlock<T>& u, const TColumnBlock<T>& v)
+  {
+    if (u.size() != v.size()) throw out_of_range("Blocks have different number of columns");
+    for (size_t p = 0; p < u.size(); ++p)
+      update(T(1), u[p], v[p]);
+  }
+};
+
+// Разложение Холецкого A = R^T R симметричной положительно определённой
+// матрицы (используется верхний треугольник A). Хранится верхний
+// множитель R, чтобы столбцы L = R^T, которые обходят обновления,
+// были строками. Обновление A + x x^T и понижение A - x x^T выполняются
+// плоскими вращениями за O(n^2)
+template<typename T>
+class TCholesky
+{
+  TDynamicMatrix<T> r;
+
+public:
+  explicit TCholesky(const TDynamicMatrix<T>& a) : r(a.size())
+  {
+    TMATRIX_TRACE("cholesky");
+    size_t n = a.size();
+    TMATRIX_SCOPED_OP(TOpKind::Gemm, n * n * n / 3, n * n * sizeof(T));
+    for (size_t i = 0; i < n; ++i)
+      std::copy(&a[i][0] + i, &a[i][0] + n, &r[i][0] + i);
+    for (size_t k = 0; k < n; ++k) {
+      T* rk = &r[k][0];
+      if (!(rk[k] > T())) throw invalid_argument("Matrix is not positive definite");
+      T d = std::sqrt(rk[k]);
+      for (size_t j = k; j < n; ++j)
+        rk[j] /= d;
+      for (size_t i = k + 1; i < n; ++i) {
+        T* ri = &r[i][0];
+        T s = rk[i];
+        for (size_t j = i; j < n; ++j)
+          ri[j] -= s * rk[j];
+      }
+    }
+  }
+
+  size_t size() const noexcept { return r.size(); }
+
+  // верхний треугольный множитель R, ниже диагонали нули
+  const TDynamicMatrix<T>& factor() const noexcept { return r; }
+
+  // решение A x = b: R^T z = b, затем R x = z
+  TDynamicVector<T> solve(const TDynamicVector<T>& b) const
+  {
+    size_t n = r.size();
+    if (b.size() != n) throw out_of_range("Matrix and vector sizes are incompatible");
+    TMATRIX_SCOPED_OP(TOpKind::Gemv, 2 * n * n, n * n * sizeof(T));
+    TDynamicVector<T> result(b);
+    T* x = &result[0];
+    for (size_t i = 0; i < n; ++i) {
+      const T* ri = &r[i][0];
+      T xi = x[i] /= ri[i];
+      for (size_t j = i + 1; j < n; ++j)
+        x[j] -= ri[j] * xi;
+    }
+    for (size_t i = n; i-- > 0;) {
+      const T* ri = &r[i][0];
+      T s = x[i];
+      for (size_t j = i + 1; j < n; ++j)
+        s -= ri[j] * x[j];
+      x[i] = s / ri[i];
+    }
+    return result;
+  }
+
+  // разложение A + x * x^T
+  void update(TDynamicVector<T> x)
+  {
+    size_t n = r.size();
+    if (x.size() != n) throw out_of_range("Matrix and vector sizes are incompatible");
+    TMATRIX_SCOPED_OP(TOpKind::Gemv, 4 * n * n, n * n * sizeof(T));
+    TMATRIX_TRACE("cholesky_update");
+    T* px = &x[0];
+    for (size_t k = 0; k < n; ++k) {
+      T* rk = &r[k][0];
+      T d = std::hypot(rk[k], px[k]);
+      T c = d / rk[k], s = px[k] / rk[k];
+      rk[k] = d;
+      for (size_t j = k + 1; j < n; ++j) {
+        rk[j] = (rk[j] + s * px[j]) / c;
+        px[j] = c * px[j] - s * rk[j];
+      }
+    }
+  }
+
+  // разложение A - x * x^T. Если результат не положительно определён,
+  // бросает invalid_argument и оставляет разложение прежним: условие
+  // ||R^{-T} x|| < 1 проверяется до изменения множителя
+  void downdate(TDynamicVector<T> x)
+  {
+    size_t n = r.size();
+    if (x.size() != n) throw out_of_range("Matrix and vector sizes are incompatible");
+    TMATRIX_SCOPED_OP(TOpKind::Gemv, 5 * n * n, n * n * sizeof(T));
+    TMATRIX_TRACE("cholesky_downdate");
+
+    TDynamicVector<T> zv(x);
+    T* z = &zv[0];
+    T norm2 = T();
+    for (size_t i = 0; i < n; ++i) {
+      const T* ri = &r[i][0];
+      T zi = z[i] /= ri[i];
+      norm2 += zi * zi;
+      for (size_t j = i + 1; j < n; ++j)
+        z[j] -= ri[j] * zi;
+    }
+    if (!(norm2 < T(1))) throw invalid_argument("Downdate makes the matrix indefinite");
+
+    T* px = &x[0];
+    for (size_t k = 0; k < n; ++k) {
+      T* rk = &r[k][0];
+      T d = std::sqrt((rk[k] - px[k]) * (rk[k] + px[k]));
+      T c = d / rk[k], s = px[k] / rk[k];
+      rk[k] = d;
+      for (size_t j = k + 1; j < n; ++j) {
+        rk[j] = (rk[j] - s * px[j]) / c;
+        px[j] = c * px[j] - s * rk[j];
+      }
+    }
+  }
+
+  // обновление ранга k: A + u * u^T
+  void update(const TColumnBlock<T>& u)
+  {
+    for (size_t p = 0; p < u.size(); ++p)
+      update(u[p]);
+  }
+};
+
+// Формула Шермана-Моррисона: ainv = A^{-1} заменяется на
+// (A + u v^T)^{-1} = A^{-1} - (A^{-1} u)(v^T A^{-1}) / (1 + v^T A^{-1} u)
+// за O(n^2). Если знаменатель равен нулю (обновлённая матрица
+// вырождена), бросает invalid_argument, ainv не изменяется
+template<typename T>
+void sherman_morrison_update(TDynamicMatrix<T>& ainv, const TDynamicVector<T>& u, const TDynamicVector<T>& v)
+{
+  size_t n = ainv.size();
+  if (u.size() != n || v.size() != n)
+    throw out_of_range("Matrix and vector sizes are incompatible");
+  TMATRIX_TRACE("sherman_morrison");
+  TDynamicVector<T> w = ainv.multiply(u);
+  TDynamicVector<T> z = ainv.left_multiply(v);
+  T denom = T(1) + v.dot(w);
+  if (denom == T()) throw invalid_argument("Update makes the matrix singular");
+  ger(-T(1) / denom, w, z, ainv);
+}
+
+// Формула Вудбери для обновления ранга k: ainv заменяется на
+// (A + U V^T)^{-1} = A^{-1} - A^{-1} U (I + V^T A^{-1} U)^{-1} V^T A^{-1},
+// где U и V - блоки n x k; O(k n^2 + k^3). Малая система k x k
+// решается через TLU, при её вырожденности бросается invalid_argument
+template<typename T>
+void woodbury_update(TDynamicMatrix<T>& ainv, const TColumnBlock<T>& u, const TColumnBlock<T>& v)
+{
+  size_t n = ainv.size(), k = u.size();
+  if (v.size() != k)
+    throw out_of_range("Blocks have different number of columns");
+  for (size_t p = 0; p < k; ++p)
+    if (u[p].size() != n || v[p].size() != n)
+      throw out_of_range("Matrix and block sizes are incompatible");
+  if (k == 0) return;
+  TMATRIX_TRACE("woodbury");
+
+  // W = A^{-1} U, Z = V^T A^{-1} (строки Z хранятся как столбцы блока)
+  TColumnBlock<T> w(k), z(k);
+  for (size_t p = 0; p < k; ++p) {
+    w[p] = ainv.multiply(u[p]);
+    z[p] = ainv.left_multiply(v[p]);
+  }
+  TDynamicMatrix<T> s(k);
+  for (size_t p = 0; p < k; ++p)
+    for (size_t q = 0; q < k; ++q)
+      s[p][q] = (p == q ? T(1) : T()) + v[p].dot(w[q]);
+  TLU<T> lu(s);
+
+  // Y = S^{-1} Z по столбцам Z^T длины k
+  TColumnBlock<T> y = make_column_block<T>(n, k);
+  TDynamicVector<T> col(k);
+  for (size_t j = 0; j < n; ++j) {
+    for (size_t p = 0; p < k; ++p)
+      col[p] = z[p][j];
+    TDynamicVector<T> sol = lu.solve(col);
+    for (size_t p = 0; p < k; ++p)
+      y[p][j] = sol[p];
+  }
+  rank_k_update(-T(1), w, y, ainv);
+}
+
+#endif
@@ -0,0 +1,247 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Числа половинной точности float16 и bfloat16
+
+#ifndef __THalf_H__
+#define __THalf_H__
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "tmatrix.h"
+
+#if defined(__F16C__) && defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace half_detail
+{
+  inline uint32_t float_bits(float f)
+  {
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    return x;
+  }
+
+  inline float bits_float(uint32_t x)
+  {
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+  }
+
+  // float -> IEEE binary16 с округлением к ближайшему чётному
+  inline uint16_t float_to_half(float f)
+  {
+    uint32_t x = float_bits(f);
+    uint16_t sign = static_cast<uint16_t>((x >> 16) & 0x8000);
+    x &= 0x7fffffff;
+    if (x >= 0x7f800000)  // inf, nan
+      return sign | (x > 0x7f800000 ? 0x7e00 : 0x7c00);
+    if (x >= 0x477ff000)  // переполнение
+      return sign | 0x7c00;
+    if (x < 0x38800000) { // денормализованные: округление выполняет сложение
+      uint32_t t = float_bits(bits_float(x) + 0.5f);
+      return sign | static_cast<uint16_t>(t - 0x3f000000);
+    }
+    uint32_t odd = (x >> 13) & 1;
+    x += 0xc8000fff + odd;
+    return sign | static_cast<uint16_t>(x >> 13);
+  }
+
+  inline float half_to_float(uint16_t h)
+  {
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    uint32_t e = (h >> 10) & 0x1f;
+    uint32_t m = h & 0x3ff;
+    if (e == 0) {
+      float f = static_cast<float>(m) * 5.9604644775390625e-8f; // m * 2^-24
+      return bits_float(float_bits(f) | sign);
+    }
+    if (e == 31)
+      return bits_float(sign | 0x7f800000 | (m << 13));
+    return bits_float(sign | ((e + 112) << 23) | (m << 13));
+  }
+
+  // float -> bfloat16 с округлением к ближайшему чётному
+  inline uint16_t float_to_bfloat(float f)
+  {
+    uint32_t x = float_bits(f);
+    if ((x & 0x7fffffff) > 0x7f800000)
+      return static_cast<uint16_t>((x >> 16) | 0x40);
+    x += 0x7fff + ((x >> 16) & 1);
+    return static_cast<uint16_t>(x >> 16);
+  }
+
+  inline float bfloat_to_float(uint16_t b)
+  {
+    return bits_float(static_cast<uint32_t>(b) << 16);
+  }
+}
+
+// Число половинной точности IEEE binary16: хранится в 16 битах,
+// арифметика выполняется через float
+struct TFloat16
+{
+  uint16_t bits;
+
+  TFloat16() : bits(0) {}
+  TFloat16(float f) : bits(half_detail::float_to_half(f)) {}
+  operator float() const { return half_detail::half_to_float(bits); }
+
+  TFloat16& operator+=(float f) { return *this = float(*this) + f; }
+  TFloat16& operator-=(float f) { return *this = float(*this) - f; }
+  TFloat16& operator*=(float f) { return *this = float(*this) * f; }
+  TFloat16& operator/=(float f) { return *this = float(*this) / f; }
+
+  friend istream& operator>>(istream& istr, TFloat16& h)
+  {
+    float f;
+    if (istr >> f) h = f;
+    return istr;
+  }
+};
+
+// Число bfloat16: старшие 16 бит float (8 бит порядка, 7 бит мантиссы)
+struct TBFloat16
+{
+  uint16_t bits;
+
+  TBFloat16() : bits(0) {}
+  TBFloat16(float f) : bits(half_detail::float_to_bfloat(f)) {}
+  operator float() const { return half_detail::bfloat_to_float(bits); }
+
+  TBFloat16& operator+=(float f) { return *this = float(*this) + f; }
+  TBFloat16& operator-=(float f) { return *this = float(*this) - f; }
+  TBFloat16& operator*=(float f) { return *this = float(*this) * f; }
+  TBFloat16& operator/=(float f) { return *this = float(*this) / f; }
+
+  friend istream& operator>>(istream& istr, TBFloat16& h)
+  {
+    float f;
+    if (istr >> f) h = f;
+    return istr;
+  }
+};
+
+static_assert(sizeof(TFloat16) == 2, "TFloat16 must occupy 2 bytes");
+static_assert(sizeof(TBFloat16) == 2, "TBFloat16 must occupy 2 bytes");
+
+// Пакетные преобразования; для float16 используется F16C, если код
+// собран с ним (-mf16c: TMATRIX_F16C или TMATRIX_NATIVE)
+inline void to_float(const TFloat16* src, float* dst, size_t n)
+{
+  size_t i = 0;
+#if defined(__F16C__) && defined(__AVX__)
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+#endif
+  for (; i < n; ++i)
+    dst[i] = half_detail::half_to_float(src[i].bits);
+}
+
+inline void from_float(const float* src, TFloat16* dst, size_t n)
+{
+  size_t i = 0;
+#if defined(__F16C__) && defined(__AVX__)
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+  }
+#endif
+  for (; i < n; ++i)
+    dst[i].bits = half_detail::float_to_half(src[i]);
+}
+
+inline void to_float(const TBFloat16* src, float* dst, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    dst[i] = half_detail::bfloat_to_float(src[i].bits);
+}
+
+inline void from_float(const float* src, TBFloat16* dst, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    dst[i].bits = half_detail::float_to_bfloat(src[i]);
+}
+
+// Преобразование векторов
+template<typename H>
+TDynamicVector<H> to_low_precision(const TDynamicVector<float>& v)
+{
+  TDynamicVector<H> result(v.size());
+  from_float(&v[0], &result[0], v.size());
+  return result;
+}
+
+template<typename H>
+TDynamicVector<float> to_float_vector(const TDynamicVector<H>& v)
+{
+  TDynamicVector<float> result(v.size());
+  to_float(&v[0], &result[0], v.size());
+  return result;
+}
+
+namespace half_detail
+{
+  constexpr size_t CHUNK = 256; // элементы преобразуются порциями через буфер на стеке
+
+  // порция a преобразуется во float и передаётся тому же ядру, что и
+  // в gemv_detail, с gemv_detail::LANES аккумуляторами
+  template<typename H>
+  float dot_chunked(const H* a, const float* x, size_t n)
+  {
+    float buf[CHUNK];
+    float sum = 0.0f;
+    for (size_t i0 = 0; i0 < n; i0 += CHUNK) {
+      size_t len = std::min(CHUNK, n - i0);
+      to_float(a + i0, buf, len);
+      sum += gemv_detail::dot_row(buf, x + i0, len, 1.0f, 0.0f, 0.0f);
+    }
+    return sum;
+  }
+}
+
+// Скалярное произведение с накоплением во float
+template<typename H>
+float dot_f32(const TDynamicVector<H>& a, const TDynamicVector<H>& b)
+{
+  if (a.size() != b.size()) throw out_of_range("Vectors are of different sizes");
+  float buf[half_detail::CHUNK];
+  float sum = 0.0f;
+  for (size_t i0 = 0; i0 < a.size(); i0 += half_detail::CHUNK) {
+    size_t len = std::min(half_detail::CHUNK, a.size() - i0);
+    to_float(&b[i0], buf, len);
+    sum += half_detail::dot_chunked(&a[i0], buf, len);
+  }
+  return sum;
+}
+
+// y = A * x: матрица хранится в половинной точности, x и y - во float.
+// Строки делятся между потоками блоками, как в gemv_detail::gemv
+template<typename H>
+void gemv_f32(const TDynamicMatrix<H>& a, const TDynamicVector<float>& x, TDynamicVector<float>& y)
+{
+  size_t n = a.size();
+  if (x.size() != n || y.size() != n)
+    throw out_of_range("Matrix and vector sizes are incompatible");
+  const TDynamicVector<H>* rows = &a[0];
+  const float* px = &x[0];
+  float* py = &y[0];
+  long long blocks = static_cast<long long>((n + gemv_detail::ROW_BLOCK - 1) / gemv_detail::ROW_BLOCK);
+#pragma omp parallel for schedule(static) if(n >= 128)
+  for (long long blk = 0; blk < blocks; ++blk) {
+    size_t i0 = static_cast<size_t>(blk) * gemv_detail::ROW_BLOCK;
+    size_t i1 = std::min(n, i0 + gemv_detail::ROW_BLOCK);
+    for (size_t i = i0; i < i1; ++i) {
+      if (i + 1 < i1) gemv_detail::prefetch_row(&rows[i + 1][0], n);
+      py[i] = half_detail::dot_chunked(&rows[i][0], px, n);
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,136 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// 64-битная хеш-функция содержимого в духе xxHash64
+
+#ifndef __THash_H__
+#define __THash_H__
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace hash_detail
+{
+  const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+  const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+  const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+  const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+  const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+  inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+  inline uint64_t round(uint64_t acc, uint64_t word)
+  {
+    acc += word * PRIME2;
+    return rotl(acc, 31) * PRIME1;
+  }
+
+  inline uint64_t merge(uint64_t h, uint64_t v)
+  {
+    h ^= round(0, v);
+    return h * PRIME1 + PRIME4;
+  }
+
+  // Хеш последовательности из count 64-битных слов word(i) с длиной
+  // данных bytes: четыре независимые полосы по слову на полосу за шаг
+  // (как у xxHash64), затем хвост по слову и перемешивание
+  template<typename W>
+  uint64_t hash_words(W word, size_t count, uint64_t bytes, uint64_t seed = 0)
+  {
+    uint64_t h;
+    size_t i = 0;
+    if (count >= 4) {
+      uint64_t v1 = seed + PRIME1 + PRIME2, v2 = seed + PRIME2, v3 = seed, v4 = seed - PRIME1;
+      for (; i + 4 <= count; i += 4) {
+        v1 = round(v1, word(i));
+        v2 = round(v2, word(i + 1));
+        v3 = round(v3, word(i + 2));
+        v4 = round(v4, word(i + 3));
+      }
+      h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+      h = merge(h, v1);
+      h = merge(h, v2);
+      h = merge(h, v3);
+      h = merge(h, v4);
+    }
+    else {
+      h = seed + PRIME5;
+    }
+    h += bytes;
+    for (; i < count; ++i) {
+      h ^= round(0, word(i));
+      h = rotl(h, 27) * PRIME1 + PRIME4;
+    }
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+  }
+
+  // хеш массива байт; хвост короче слова дополняется нулями
+  inline uint64_t hash_bytes(const void* data, size_t bytes)
+  {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    size_t full = bytes / 8;
+    return hash_words([p, full, bytes](size_t i) {
+      uint64_t w = 0;
+      std::memcpy(&w, p + i * 8, i < full ? 8 : bytes - full * 8);
+      return w;
+    }, (bytes + 7) / 8, bytes);
+  }
+
+  // двоичное представление числа с плавающей точкой, в котором -0 и +0
+  // совпадают (они равны по ==, значит, должны иметь одинаковый хеш)
+  template<typename F, typename U>
+  U float_bits(F x)
+  {
+    if (x == F()) x = F();
+    U u;
+    std::memcpy(&u, &x, sizeof(u));
+    return u;
+  }
+
+  template<typename T, typename = void>
+  struct THasHashMember : std::false_type {};
+  template<typename T>
+  struct THasHashMember<T, decltype((void)std::declval<const T&>().hash())> : std::true_type {};
+
+  // хеш массива элементов, согласованный с поэлементным ==. Побайтно
+  // хешируются те же типы, что побайтно сравниваются (compare_detail):
+  // целые, перечисления и указатели
+  template<typename T>
+  uint64_t hash_array(const T* a, size_t n)
+  {
+    if constexpr (std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value) {
+      return hash_bytes(a, n * sizeof(T));
+    }
+    else if constexpr (std::is_same<T, double>::value) {
+      return hash_words([a](size_t i) { return float_bits<double, uint64_t>(a[i]); }, n, n * sizeof(T));
+    }
+    else if constexpr (std::is_same<T, float>::value) {
+      return hash_words([a, n](size_t i) {
+        uint64_t lo = float_bits<float, uint32_t>(a[2 * i]);
+        uint64_t hi = 2 * i + 1 < n ? float_bits<float, uint32_t>(a[2 * i + 1]) : 0;
+        return lo | hi << 32;
+      }, (n + 1) / 2, n * sizeof(T));
+    }
+    else if constexpr (THasHashMember<T>::value) {
+      return hash_words([a](size_t i) { return static_cast<uint64_t>(a[i].hash()); }, n, n);
+    }
+    else if constexpr (std::is_convertible<T, double>::value) {
+      // TFloat16, TBFloat16 и др.: == сравнивает значения, а не биты
+      return hash_words([a](size_t i) { return float_bits<double, uint64_t>(static_cast<double>(a[i])); }, n, n * sizeof(T));
+    }
+    else {
+      return hash_words([a](size_t i) { return static_cast<uint64_t>(std::hash<T>()(a[i])); }, n, n);
+    }
+  }
+}
+
+#endif
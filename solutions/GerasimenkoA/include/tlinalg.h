@@ -0,0 +1,714 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Плотная линейная алгебра над TDynamicMatrix
+
+#ifndef __TLinAlg_H__
+#define __TLinAlg_H__
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include "tmatrix.h"
+#include "tsemiring.h"
+
+// Набор столбцов одинаковой длины - прямоугольный блок n x k,
+// хранящийся по столбцам (k векторов длины n)
+template<typename T>
+using TColumnBlock = TDynamicVector<TDynamicVector<T>>;
+
+template<typename T>
+TColumnBlock<T> make_column_block(size_t n, size_t k)
+{
+  TColumnBlock<T> b(k);
+  for (size_t j = 0; j < k; ++j)
+    b[j] = TDynamicVector<T>(n);
+  return b;
+}
+
+// Транспонирование блока n x k (k столбцов длины n) в блок k x n
+// (n столбцов длины k)
+template<typename T>
+TColumnBlock<T> transpose(const TColumnBlock<T>& b)
+{
+  size_t k = b.size(), n = b[0].size();
+  TColumnBlock<T> t = make_column_block<T>(k, n);
+  TMATRIX_TRACE("transpose");
+  TDynamicVector<const T*> src(k);
+  TDynamicVector<T*> dst(n);
+  for (size_t j = 0; j < k; ++j)
+    src[j] = &b[j][0];
+  for (size_t i = 0; i < n; ++i)
+    dst[i] = &t[i][0];
+  transpose_detail::transpose_copy(&src[0], &dst[0], k, n);
+  return t;
+}
+
+template<typename T>
+T dot_product(const TDynamicVector<T>& x, const TDynamicVector<T>& y)
+{
+  return x.dot(y);
+}
+
+// y += alpha * x
+template<typename T>
+void axpy(T alpha, const TDynamicVector<T>& x, TDynamicVector<T>& y)
+{
+  size_t n = x.size();
+  if (n == 0) return;
+  T* py = &y[0];
+  const T* px = &x[0];
+  for (size_t i = 0; i < n; ++i)
+    py[i] += alpha * px[i];
+}
+
+// QR-разложение блока столбцов модифицированным методом Грама-Шмидта
+// с повторной ортогонализацией: столбцы q заменяются ортонормированным
+// базисом, r (k x k, верхнетреугольная) заполняется, если передана
+template<typename T>
+void qr_orthonormalize(TColumnBlock<T>& q, TDynamicMatrix<T>* r = nullptr)
+{
+  TMATRIX_TRACE("qr");
+  size_t k = q.size();
+  for (size_t j = 0; j < k; ++j) {
+    for (int pass = 0; pass < 2; ++pass) {
+      for (size_t i = 0; i < j; ++i) {
+        T c = dot_product(q[i], q[j]);
+        axpy(-c, q[i], q[j]);
+        if (r) (*r)[i][j] += c;
+      }
+    }
+    T norm = std::sqrt(dot_product(q[j], q[j]));
+    if (r) (*r)[j][j] = norm;
+    if (norm > T()) {
+      for (size_t i = 0; i < q[j].size(); ++i)
+        q[j][i] /= norm;
+    }
+  }
+}
+
+// Произведение c = a * b в заранее выделенную матрицу c
+// (c не должна совпадать с a или b)
+template<typename T>
+void multiply_into(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, TDynamicMatrix<T>& c)
+{
+  semiring_multiply_into(a, b, c, TPlusTimes<T>());
+}
+
+// c = op(a) * op(b) без явного транспонирования операндов
+template<typename T>
+void multiply_into(const TDynamicMatrix<T>& a, TTrans ta, const TDynamicMatrix<T>& b, TTrans tb,
+  TDynamicMatrix<T>& c)
+{
+  size_t n = a.size();
+  TMATRIX_SCOPED_OP(TOpKind::Gemm, 2 * n * n * n, 3 * n * n * sizeof(T));
+  semiring_multiply_into(a, ta, b, tb, c, TPlusTimes<T>());
+}
+
+template<typename T>
+TDynamicMatrix<T> multiply(const TDynamicMatrix<T>& a, TTrans ta, const TDynamicMatrix<T>& b, TTrans tb)
+{
+  TDynamicMatrix<T> c(a.size());
+  multiply_into(a, ta, b, tb, c);
+  return c;
+}
+
+// c = alpha * op(a) * op(b) + beta * c (BLAS gemm) в существующую матрицу c,
+// c не должна совпадать с a или b. При beta == 0 прежнее содержимое c
+// не читается (NaN в c не попадает в результат). Новая память выделяется
+// только под буфер панели транспонированного b при первом вызове
+// данного размера в потоке
+template<typename T>
+void gemm(T alpha, const TDynamicMatrix<T>& a, TTrans ta, const TDynamicMatrix<T>& b, TTrans tb,
+  T beta, TDynamicMatrix<T>& c)
+{
+  using namespace semiring_detail;
+  size_t n = a.size();
+  if (b.size() != n || c.size() != n)
+    throw out_of_range("Matrices have different sizes");
+  TMATRIX_SCOPED_OP(TOpKind::Gemm, 2 * n * n * n, 3 * n * n * sizeof(T));
+  TMATRIX_TRACE("gemm");
+  bool transA = ta == TTrans::Yes, transB = tb == TTrans::Yes;
+  long long blocks = static_cast<long long>((n + ROW_BLOCK - 1) / ROW_BLOCK);
+  T** cr = workspace<T*>(n);
+  c.row_pointers(cr);
+
+#pragma omp parallel for if(n >= 128)
+  for (long long ii = 0; ii < static_cast<long long>(n); ++ii) {
+    T* ci = cr[ii];
+    if (beta == T())
+      std::fill(ci, ci + n, T());
+    else if (beta != T(1))
+      for (size_t j = 0; j < n; ++j)
+        ci[j] *= beta;
+  }
+  if (alpha == T()) return;
+
+  T* bp = transB ? workspace<T>(std::min(n, DEPTH_BLOCK) * n) : nullptr;
+  for (size_t k0 = 0; k0 < n; k0 += DEPTH_BLOCK) {
+    size_t k1 = std::min(n, k0 + DEPTH_BLOCK);
+    if (transB) pack_transposed_panel(b, k0, k1, bp);
+#pragma omp parallel for schedule(dynamic) if(n >= 128)
+    for (long long blk = 0; blk < blocks; ++blk) {
+      size_t i0 = static_cast<size_t>(blk) * ROW_BLOCK;
+      size_t i1 = std::min(n, i0 + ROW_BLOCK);
+      for (size_t i = i0; i < i1; ++i) {
+        T* ci = cr[i];
+        for (size_t k = k0; k < k1; ++k) {
+          T aik = alpha * (transA ? a[k][i] : a[i][k]);
+          const T* bk = transB ? bp + (k - k0) * n : &b[k][0];
+          TRowUpdate<T, TPlusTimes<T>>::run(TPlusTimes<T>(), ci, aik, bk, n);
+        }
+      }
+    }
+  }
+}
+
+// y = alpha * op(a) * x + beta * y (BLAS gemv) в существующий вектор y,
+// y не должен совпадать с x. При beta == 0 прежнее содержимое y не читается
+template<typename T>
+void gemv(T alpha, const TDynamicMatrix<T>& a, TTrans ta, const TDynamicVector<T>& x,
+  T beta, TDynamicVector<T>& y)
+{
+  size_t n = a.size();
+  if (x.size() != n || y.size() != n)
+    throw out_of_range("Matrix and vector sizes are incompatible");
+  if (TProductCache<T>::installed()) {
+    // кэшируется op(a) * x, масштабирование применяется к найденному результату
+    TDynamicVector<T> p = ta == TTrans::No ? a.multiply(x) : a.left_multiply(x);
+    for (size_t i = 0; i < n; ++i)
+      y[i] = beta == T() ? alpha * p[i] : alpha * p[i] + beta * y[i];
+    return;
+  }
+  TMATRIX_SCOPED_OP(TOpKind::Gemv, 2 * n * n, (n * n + 2 * n) * sizeof(T));
+  TMATRIX_TRACE("gemv");
+
+  if (ta == TTrans::No)
+    gemv_detail::gemv(&a[0], n, &x[0], alpha, beta, &y[0]);
+  else
+    gemv_detail::gemv_transposed(&a[0], n, &x[0], alpha, beta, &y[0]);
+}
+
+// Симметричное произведение (BLAS syrk): c = a * a^T при t == No,
+// c = a^T * a при t == Yes. Вычисляется только треугольник uplo
+// (вдвое меньше операций), второй треугольник c не изменяется
+template<typename T>
+void syrk(const TDynamicMatrix<T>& a, TTrans t, TDynamicMatrix<T>& c, TTriangle uplo = TTriangle::Upper)
+{
+  size_t n = a.size();
+  if (c.size() != n)
+    throw out_of_range("Matrices have different sizes");
+  TMATRIX_SCOPED_OP(TOpKind::Gemm, n * n * (n + 1), 2 * n * n * sizeof(T));
+  TMATRIX_TRACE("syrk");
+  bool upper = uplo == TTriangle::Upper;
+  T** cr = semiring_detail::workspace<T*>(n);
+  c.row_pointers(cr);
+
+  if (t == TTrans::No) {
+    // c[i][j] - скалярное произведение строк i и j
+#pragma omp parallel for schedule(dynamic) if(n >= 128)
+    for (long long ii = 0; ii < static_cast<long long>(n); ++ii) {
+      TMATRIX_MUTE_STATS();
+      size_t i = static_cast<size_t>(ii);
+      size_t j0 = upper ? i : 0, j1 = upper ? n : i + 1;
+      for (size_t j = j0; j < j1; ++j)
+        cr[i][j] = a[i].dot(a[j]);
+    }
+    return;
+  }
+
+  // c[i][j] += a[k][i] * a[k][j] для j в треугольнике строки i,
+  // блоками строк c и глубины k, как в semiring_multiply_into
+  using namespace semiring_detail;
+  long long blocks = static_cast<long long>((n + ROW_BLOCK - 1) / ROW_BLOCK);
+#pragma omp parallel for schedule(dynamic) if(n >= 128)
+  for (long long blk = 0; blk < blocks; ++blk) {
+    size_t i0 = static_cast<size_t>(blk) * ROW_BLOCK;
+    size_t i1 = std::min(n, i0 + ROW_BLOCK);
+    for (size_t i = i0; i < i1; ++i) {
+      size_t j0 = upper ? i : 0, j1 = upper ? n : i + 1;
+      std::fill(cr[i] + j0, cr[i] + j1, T());
+    }
+    for (size_t k0 = 0; k0 < n; k0 += DEPTH_BLOCK) {
+      size_t k1 = std::min(n, k0 + DEPTH_BLOCK);
+      for (size_t i = i0; i < i1; ++i) {
+        size_t j0 = upper ? i : 0, j1 = upper ? n : i + 1;
+        T* ci = cr[i] + j0;
+        for (size_t k = k0; k < k1; ++k)
+          TRowUpdate<T, TPlusTimes<T>>::run(TPlusTimes<T>(), ci, a[k][i], &a[k][0] + j0, j1 - j0);
+      }
+    }
+  }
+}
+
+// Матрица Грама a^T * a целиком: верхний треугольник через syrk
+// и его отражение в нижний
+template<typename T>
+TDynamicMatrix<T> gram(const TDynamicMatrix<T>& a)
+{
+  size_t n = a.size();
+  TDynamicMatrix<T> c(n);
+  syrk(a, TTrans::Yes, c, TTriangle::Upper);
+  for (size_t i = 1; i < n; ++i)
+    for (size_t j = 0; j < i; ++j)
+      c[i][j] = c[j][i];
+  return c;
+}
+
+// Обновление ранга 1 (BLAS ger): a += alpha * x * y^T на месте, O(n^2)
+template<typename T>
+void ger(T alpha, const TDynamicVector<T>& x, const TDynamicVector<T>& y, TDynamicMatrix<T>& a)
+{
+  size_t n = a.size();
+  if (x.size() != n || y.size() != n)
+    throw out_of_range("Matrix and vector sizes are incompatible");
+  TMATRIX_SCOPED_OP(TOpKind::Gemv, 2 * n * n, (2 * n * n + 2 * n) * sizeof(T));
+  TMATRIX_TRACE("ger");
+
+  using namespace semiring_detail;
+  T** ar = workspace<T*>(n);
+  a.row_pointers(ar);
+#pragma omp parallel for if(n >= 256)
+  for (long long ii = 0; ii < static_cast<long long>(n); ++ii) {
+    size_t i = static_cast<size_t>(ii);
+    TRowUpdate<T, TPlusTimes<T>>::run(TPlusTimes<T>(), ar[i], alpha * x[i], &y[0], n);
+  }
+}
+
+// Симметричное обновление ранга 1 (BLAS syr): a += alpha * x * x^T,
+// изменяется только треугольник uplo
+template<typename T>
+void syr(T alpha, const TDynamicVector<T>& x, TDynamicMatrix<T>& a, TTriangle uplo = TTriangle::Upper)
+{
+  size_t n = a.size();
+  if (x.size() != n)
+    throw out_of_range("Matrix and vector sizes are incompatible");
+  TMATRIX_SCOPED_OP(TOpKind::Gemv, n * (n + 1), (n * (n + 1) + n) * sizeof(T));
+  TMATRIX_TRACE("syr");
+  bool upper = uplo == TTriangle::Upper;
+
+  using namespace semiring_detail;
+  T** ar = workspace<T*>(n);
+  a.row_pointers(ar);
+#pragma omp parallel for if(n >= 256)
+  for (long long ii = 0; ii < static_cast<long long>(n); ++ii) {
+    size_t i = static_cast<size_t>(ii);
+    size_t j0 = upper ? i : 0, j1 = upper ? n : i + 1;
+    TRowUpdate<T, TPlusTimes<T>>::run(TPlusTimes<T>(), ar[i] + j0, alpha * x[i], &x[0] + j0, j1 - j0);
+  }
+}
+
+// Обновление ранга k: a += alpha * u * v^T, где u и v - блоки n x k;
+// каждая строка a обновляется k раз, пока находится в кэше, O(k n^2)
+template<typename T>
+void rank_k_update(T alpha, const TColumnBlock<T>& u, const TColumnBlock<T>& v, TDynamicMatrix<T>& a)
+{
+  size_t n = a.size(), k = u.size();
+  if (v.size() != k)
+    throw out_of_range("Blocks have different number of columns");
+  for (size_t p = 0; p < k; ++p)
+    if (u[p].size() != n || v[p].size() != n)
+      throw out_of_range("Matrix and block sizes are incompatible");
+  TMATRIX_SCOPED_OP(TOpKind::Gemm, 2 * k * n * n, (2 * n * n + 2 * k * n) * sizeof(T));
+  TMATRIX_TRACE("rank_k_update");
+
+  using namespace semiring_detail;
+  T** ar = workspace<T*>(n);
+  a.row_pointers(ar);
+#pragma omp parallel for if(n >= 256)
+  for (long long ii = 0; ii < static_cast<long long>(n); ++ii) {
+    size_t i = static_cast<size_t>(ii);
+    T* ai = ar[i];
+    for (size_t p = 0; p < k; ++p)
+      TRowUpdate<T, TPlusTimes<T>>::run(TPlusTimes<T>(), ai, alpha * u[p][i], &v[p][0], n);
+  }
+}
+
+// Симметричное обновление ранга k: a += alpha * u * u^T в треугольнике uplo
+template<typename T>
+void symmetric_rank_k_update(T alpha, const TColumnBlock<T>& u, TDynamicMatrix<T>& a,
+  TTriangle uplo = TTriangle::Upper)
+{
+  size_t n = a.size(), k = u.size();
+  for (size_t p = 0; p < k; ++p)
+    if (u[p].size() != n)
+      throw out_of_range("Matrix and block sizes are incompatible");
+  TMATRIX_SCOPED_OP(TOpKind::Gemm, k * n * (n + 1), (n * (n + 1) + k * n) * sizeof(T));
+  TMATRIX_TRACE("symmetric_rank_k_update");
+  bool upper = uplo == TTriangle::Upper;
+
+  using namespace semiring_detail;
+  T** ar = workspace<T*>(n);
+  a.row_pointers(ar);
+#pragma omp parallel for schedule(dynamic, 16) if(n >= 256)
+  for (long long ii = 0; ii < static_cast<long long>(n); ++ii) {
+    size_t i = static_cast<size_t>(ii);
+    size_t j0 = upper ? i : 0, j1 = upper ? n : i + 1;
+    T* ai = ar[i] + j0;
+    for (size_t p = 0; p < k; ++p)
+      TRowUpdate<T, TPlusTimes<T>>::run(TPlusTimes<T>(), ai, alpha * u[p][i], &u[p][0] + j0, j1 - j0);
+  }
+}
+
+// То же по модулю mod для целых T (mod <= 2^32)
+template<typename T>
+void multiply_mod_into(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, TDynamicMatrix<T>& c, T mod)
+{
+  semiring_multiply_into(a, b, c, TModPlusTimes<T>(mod));
+}
+
+namespace linalg_detail
+{
+  template<typename T>
+  void copy_elements(const TDynamicMatrix<T>& src, TDynamicMatrix<T>& dst)
+  {
+    for (size_t i = 0; i < src.size(); ++i)
+      std::copy(&src[i][0], &src[i][0] + src.size(), &dst[i][0]);
+  }
+
+  // Бинарное возведение в степень: result и base используют общий
+  // буфер scratch поочерёдно, после выделения трёх матриц новых
+  // выделений памяти нет; mul(x, y, z) вычисляет z = x * y
+  template<typename T, typename Mul>
+  TDynamicMatrix<T> power_impl(const TDynamicMatrix<T>& a, unsigned long long k, T one, Mul mul)
+  {
+    size_t n = a.size();
+    TDynamicMatrix<T> result(n), base(n), scratch(n);
+    if (k == 0) {
+      for (size_t i = 0; i < n; ++i)
+        result[i][i] = one;
+      return result;
+    }
+    copy_elements(a, base);
+    bool empty = true;
+    while (true) {
+      if (k & 1) {
+        if (empty) {
+          copy_elements(base, result);
+          empty = false;
+        }
+        else {
+          mul(result, base, scratch);
+          std::swap(result, scratch);
+        }
+      }
+      k >>= 1;
+      if (k == 0)
+        break;
+      mul(base, base, scratch);
+      std::swap(base, scratch);
+    }
+    return result;
+  }
+}
+
+// Степень матрицы a^k за O(log2 k) умножений
+template<typename T>
+TDynamicMatrix<T> power(const TDynamicMatrix<T>& a, unsigned long long k)
+{
+  return linalg_detail::power_impl(a, k, T(1),
+    [](const TDynamicMatrix<T>& x, const TDynamicMatrix<T>& y, TDynamicMatrix<T>& z) {
+      multiply_into(x, y, z);
+    });
+}
+
+// Степень матрицы a^k по модулю mod (целые T, 0 < mod <= 2^32)
+template<typename T>
+TDynamicMatrix<T> power_mod(const TDynamicMatrix<T>& a, unsigned long long k, T mod)
+{
+  static_assert(std::is_integral<T>::value, "power_mod requires integral type");
+  if (mod <= T(0))
+    throw invalid_argument("Modulus should be positive");
+  size_t n = a.size();
+  TDynamicMatrix<T> reduced(n);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      reduced[i][j] = static_cast<T>(((a[i][j] % mod) + mod) % mod);
+  return linalg_detail::power_impl(reduced, k, static_cast<T>(1 % mod),
+    [mod](const TDynamicMatrix<T>& x, const TDynamicMatrix<T>& y, TDynamicMatrix<T>& z) {
+      multiply_mod_into(x, y, z, mod);
+    });
+}
+
+// Результат усечённого SVD: A ~ U * diag(S) * V^T,
+// U и V хранятся как блоки столбцов, S - по убыванию
+template<typename T>
+struct TSvdResult
+{
+  TColumnBlock<T> U;
+  TDynamicVector<T> S;
+  TColumnBlock<T> V;
+};
+
+// Параметры рандомизированного SVD
+struct TRandomizedSvdParams
+{
+  size_t oversampling = 10;  // запас столбцов эскиза сверх k
+  size_t powerIters = 2;     // число степенных итераций
+  bool singlePass = false;   // однопроходный режим (без степенных итераций)
+  unsigned seed = 0;
+};
+
+// Одностороннее вращение Якоби над строками b (l векторов длины n):
+// b^T = U' * diag(sigma) * V'^T, b заменяется на U' * diag(sigma), v = V'
+template<typename T>
+void jacobi_one_sided(TColumnBlock<T>& b, TDynamicMatrix<T>& v)
+{
+  size_t l = b.size();
+  const T eps = std::numeric_limits<T>::epsilon() * T(l);
+  for (size_t i = 0; i < l; ++i)
+    v[i][i] = T(1);
+
+  for (int sweep = 0; sweep < 60; ++sweep) {
+    bool rotated = false;
+    for (size_t p = 0; p + 1 < l; ++p) {
+      for (size_t q = p + 1; q < l; ++q) {
+        T alpha = dot_product(b[p], b[p]);
+        T beta = dot_product(b[q], b[q]);
+        T gamma = dot_product(b[p], b[q]);
+        if (std::abs(gamma) <= eps * std::sqrt(alpha * beta))
+          continue;
+        rotated = true;
+        T zeta = (beta - alpha) / (T(2) * gamma);
+        T t = (zeta >= T() ? T(1) : T(-1)) / (std::abs(zeta) + std::sqrt(T(1) + zeta * zeta));
+        T c = T(1) / std::sqrt(T(1) + t * t);
+        T s = c * t;
+        for (size_t i = 0; i < b[p].size(); ++i) {
+          T x = b[p][i], y = b[q][i];
+          b[p][i] = c * x - s * y;
+          b[q][i] = s * x + c * y;
+        }
+        for (size_t i = 0; i < l; ++i) {
+          T x = v[i][p], y = v[i][q];
+          v[i][p] = c * x - s * y;
+          v[i][q] = s * x + c * y;
+        }
+      }
+    }
+    if (!rotated)
+      break;
+  }
+}
+
+namespace svd_detail
+{
+  // y[j][i] = (a[i], x[j]) для строк i из [i0, i1): группа из ROWS строк
+  // умножается ядром dot_rows прямого gemv на все столбцы x, пока
+  // находится в кэше, так что A читается один раз на всё произведение
+  template<typename T>
+  void row_range_times_columns(const TDynamicVector<T>* a, size_t i0, size_t i1, size_t n,
+    const TColumnBlock<T>& x, T* const* yc)
+  {
+    using namespace gemv_detail;
+    size_t l = x.size();
+    size_t i = i0;
+    for (; i + ROWS <= i1; i += ROWS) {
+      T out[ROWS];
+      for (size_t j = 0; j < l; ++j) {
+        dot_rows(a + i, &x[j][0], n, T(1), T(), out);
+        for (size_t q = 0; q < ROWS; ++q)
+          yc[j][i + q] = out[q];
+      }
+    }
+    for (; i < i1; ++i)
+      for (size_t j = 0; j < l; ++j)
+        yc[j][i] = dot_row(&a[i][0], &x[j][0], n, T(1), T(), T());
+  }
+
+  // Y = A * X: A - m строк длины n, X - l столбцов длины n, Y - l столбцов
+  // длины m; блоки строк A делятся между потоками, как в gemv
+  template<typename T>
+  void rows_times_columns(const TDynamicVector<T>* a, size_t m, size_t n,
+    const TColumnBlock<T>& x, TColumnBlock<T>& y)
+  {
+    using gemv_detail::ROW_BLOCK;
+    size_t l = x.size();
+    T** yc = semiring_detail::workspace<T*>(l);
+    for (size_t j = 0; j < l; ++j)
+      yc[j] = &y[j][0];
+    long long blocks = static_cast<long long>((m + ROW_BLOCK - 1) / ROW_BLOCK);
+#pragma omp parallel for schedule(static) if(m >= 128)
+    for (long long blk = 0; blk < blocks; ++blk) {
+      size_t i0 = static_cast<size_t>(blk) * ROW_BLOCK;
+      row_range_times_columns(a, i0, std::min(m, i0 + ROW_BLOCK), n, x, yc);
+    }
+  }
+
+  // Y = A^T * X: X - l столбцов длины m, Y - l столбцов длины n. Как в
+  // gemv_transposed: потоки делят столбцы A на отрезки по COLUMN_BLOCK,
+  // строки A добавляются группами по ROWS ко всем l отрезкам Y
+  template<typename T>
+  void rows_transposed_times_columns(const TDynamicVector<T>* a, size_t m, size_t n,
+    const TColumnBlock<T>& x, TColumnBlock<T>& y)
+  {
+    using namespace gemv_detail;
+    size_t l = x.size();
+    T** yc = semiring_detail::workspace<T*>(l);
+    for (size_t j = 0; j < l; ++j)
+      yc[j] = &y[j][0];
+    long long chunks = static_cast<long long>((n + COLUMN_BLOCK - 1) / COLUMN_BLOCK);
+#pragma omp parallel for if(n >= 256)
+    for (long long ch = 0; ch < chunks; ++ch) {
+      size_t c0 = static_cast<size_t>(ch) * COLUMN_BLOCK, c1 = std::min(n, c0 + COLUMN_BLOCK);
+      for (size_t j = 0; j < l; ++j)
+        std::fill(yc[j] + c0, yc[j] + c1, T());
+      size_t i = 0;
+      for (; i + ROWS <= m; i += ROWS) {
+        const T* r0 = &a[i][0];
+        const T* r1 = &a[i + 1][0];
+        const T* r2 = &a[i + 2][0];
+        const T* r3 = &a[i + 3][0];
+        for (size_t j = 0; j < l; ++j) {
+          const T* xj = &x[j][0];
+          T s0 = xj[i], s1 = xj[i + 1], s2 = xj[i + 2], s3 = xj[i + 3];
+          T* yj = yc[j];
+          for (size_t c = c0; c < c1; ++c)
+            yj[c] += s0 * r0[c] + s1 * r1[c] + s2 * r2[c] + s3 * r3[c];
+        }
+      }
+      for (; i < m; ++i) {
+        const T* ri = &a[i][0];
+        for (size_t j = 0; j < l; ++j) {
+          T si = x[j][i];
+          T* yj = yc[j];
+          for (size_t c = c0; c < c1; ++c)
+            yj[c] += si * ri[c];
+        }
+      }
+    }
+  }
+
+  // Рандомизированное SVD матрицы m x n, заданной массивом строк
+  template<typename T>
+  TSvdResult<T> randomized_svd(const TDynamicVector<T>* a, size_t m, size_t n, size_t k,
+    const TRandomizedSvdParams& params)
+  {
+    static_assert(std::is_floating_point<T>::value, "randomized_svd requires floating point type");
+    size_t p = std::min(m, n);
+    if (k == 0 || k > p)
+      throw out_of_range("Rank should be in [1, smaller matrix dimension]");
+    size_t l = std::min(p, k + params.oversampling);
+    TMATRIX_TRACE("randomized_svd");
+
+    std::mt19937 gen(params.seed);
+    std::normal_distribution<T> normal;
+
+    TColumnBlock<T> omega = make_column_block<T>(n, l);
+    for (size_t j = 0; j < l; ++j)
+      for (size_t i = 0; i < n; ++i)
+        omega[j][i] = normal(gen);
+
+    TColumnBlock<T> q = make_column_block<T>(m, l);
+    TColumnBlock<T> b = make_column_block<T>(n, l); // строки B = Q^T * A
+
+    if (params.singlePass) {
+      size_t lw = std::min(m, 2 * l + 1);
+      TColumnBlock<T> psi = make_column_block<T>(m, lw); // строки Psi (lw x m)
+      for (size_t s = 0; s < lw; ++s)
+        for (size_t i = 0; i < m; ++i)
+          psi[s][i] = normal(gen);
+      TColumnBlock<T> w = make_column_block<T>(n, lw);   // строки W = Psi * A (lw x n)
+
+      // A читается ровно один раз, группами по ROWS строк
+      TDynamicVector<T*> qc(l);
+      for (size_t j = 0; j < l; ++j)
+        qc[j] = &q[j][0];
+      for (size_t i0 = 0; i0 < m; i0 += gemv_detail::ROWS) {
+        size_t i1 = std::min(m, i0 + gemv_detail::ROWS);
+        row_range_times_columns(a, i0, i1, n, omega, &qc[0]);
+        for (size_t i = i0; i < i1; ++i)
+          for (size_t s = 0; s < lw; ++s)
+            axpy(psi[s][i], a[i], w[s]);
+      }
+      qr_orthonormalize(q);
+
+      // X = (Psi * Q)^+ * W через QR матрицы Psi * Q (lw x l)
+      TColumnBlock<T> pq = make_column_block<T>(lw, l);
+      for (size_t j = 0; j < l; ++j)
+        for (size_t s = 0; s < lw; ++s)
+          pq[j][s] = dot_product(psi[s], q[j]);
+      TDynamicMatrix<T> r(l);
+      qr_orthonormalize(pq, &r);
+      for (size_t j = 0; j < l; ++j)
+        for (size_t s = 0; s < lw; ++s)
+          axpy(pq[j][s], w[s], b[j]);
+      for (size_t j = l; j-- > 0;) {
+        for (size_t i = j + 1; i < l; ++i)
+          axpy(-r[j][i], b[i], b[j]);
+        T d = r[j][j];
+        for (size_t i = 0; i < n; ++i)
+          b[j][i] = d != T() ? b[j][i] / d : T();
+      }
+    }
+    else {
+      rows_times_columns(a, m, n, omega, q);
+      qr_orthonormalize(q);
+      for (size_t it = 0; it < params.powerIters; ++it) {
+        rows_transposed_times_columns(a, m, n, q, omega);
+        qr_orthonormalize(omega);
+        rows_times_columns(a, m, n, omega, q);
+        qr_orthonormalize(q);
+      }
+      rows_transposed_times_columns(a, m, n, q, b);
+    }
+
+    TDynamicMatrix<T> v(l);
+    jacobi_one_sided(b, v);
+
+    TDynamicVector<T> sigma(l);
+    for (size_t j = 0; j < l; ++j)
+      sigma[j] = std::sqrt(dot_product(b[j], b[j]));
+    TDynamicVector<size_t> order(l);
+    for (size_t j = 0; j < l; ++j)
+      order[j] = j;
+    std::sort(&order[0], &order[0] + l,
+      [&](size_t x, size_t z) { return sigma[x] > sigma[z]; });
+
+    TSvdResult<T> res;
+    res.U = make_column_block<T>(m, k);
+    res.S = TDynamicVector<T>(k);
+    res.V = make_column_block<T>(n, k);
+    for (size_t c = 0; c < k; ++c) {
+      size_t j = order[c];
+      res.S[c] = sigma[j];
+      for (size_t s = 0; s < l; ++s)
+        axpy(v[s][j], q[s], res.U[c]);
+      for (size_t i = 0; i < n; ++i)
+        res.V[c][i] = sigma[j] > T() ? b[j][i] / sigma[j] : T();
+    }
+    return res;
+  }
+}
+
+// Рандомизированное усечённое SVD (Halko, Martinsson, Tropp):
+// гауссов эскиз Y = A * Omega, степенные итерации, QR, малое плотное SVD.
+// Произведения A * Omega и A^T * Q считаются ядрами gemv_detail сразу для
+// всех столбцов блока: A читается один раз на произведение.
+// В однопроходном режиме A читается построчно ровно один раз: одновременно
+// накапливаются Y = A * Omega и W = Psi * A
+template<typename T>
+TSvdResult<T> randomized_svd(const TDynamicMatrix<T>& a, size_t k,
+  const TRandomizedSvdParams& params = TRandomizedSvdParams())
+{
+  return svd_detail::randomized_svd(&a[0], a.size(), a.size(), k, params);
+}
+
+// То же для прямоугольной матрицы m x n, заданной строками (m векторов
+// длины n, например блок из 50000 строк по 2000 элементов);
+// U - k столбцов длины m, V - k столбцов длины n
+template<typename T>
+TSvdResult<T> randomized_svd(const TColumnBlock<T>& rows, size_t k,
+  const TRandomizedSvdParams& params = TRandomizedSvdParams())
+{
+  size_t m = rows.size(), n = rows[0].size();
+  for (size_t i = 1; i < m; ++i)
+    if (rows[i].size() != n)
+      throw out_of_range("Rows have different sizes");
+  return svd_detail::randomized_svd(&rows[0], m, n, k, params);
+}
+
+#endif
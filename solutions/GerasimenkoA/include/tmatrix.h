@@ -8,32 +8,290 @@
 #define __TDynamicMatrix_H__
 
 #include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "thash.h"
+#include "tstats.h"
+#include "ttrace.h"
 
 using namespace std;
 
 const int MAX_VECTOR_SIZE = 100000000;
 const int MAX_MATRIX_SIZE = 10000;
 
+// Размер встроенного буфера вектора в байтах: короткие векторы простых
+// типов хранят элементы внутри объекта без выделения памяти (0 - отключить)
+#ifndef TDYNAMIC_VECTOR_INLINE_BYTES
+#define TDYNAMIC_VECTOR_INLINE_BYTES 64
+#endif
+
+// Способ суммирования в скалярном произведении и редукциях
+enum class TSumMode
+{
+  Fast,      // несколько независимых аккумуляторов, векторизуется компилятором
+  Pairwise,  // попарное суммирование, погрешность O(log n)
+  Kahan,     // компенсированное суммирование Кэхэна, погрешность O(1)
+  Parallel,  // параллельно по блокам, результат зависит от числа потоков
+  Reproducible // параллельно по блокам фиксированного размера со сложением
+               // частичных сумм фиксированным деревом: результат побитово
+               // одинаков при любом числе потоков
+};
+
+// Ориентация операнда произведения (как флаги transa/transb в BLAS gemm)
+enum class TTrans
+{
+  No,   // операнд берётся как есть
+  Yes   // операнд берётся транспонированным
+};
+
+// Треугольник симметричного результата (как uplo в BLAS syrk)
+enum class TTriangle
+{
+  Upper,
+  Lower
+};
+
+// Сравнение массивов блоками по BLOCK элементов: внутри блока различия
+// накапливаются без ветвлений (цикл векторизуется), выход - после
+// первого блока с различием. Побайтно (memcmp) сравниваются только целые,
+// перечисления и указатели: у остальных типов, в том числе TFloat16,
+// == может не совпадать с равенством представлений (+0 и -0, NaN)
+namespace compare_detail
+{
+  const size_t BLOCK = 64;
+
+  template<typename T>
+  constexpr bool bytewise_equality_v = std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value;
+
+  template<typename T>
+  bool equal(const T* a, const T* b, size_t n)
+  {
+    if constexpr (bytewise_equality_v<T>)
+      return n == 0 || std::memcmp(a, b, n * sizeof(T)) == 0;
+    for (size_t i0 = 0; i0 < n; i0 += BLOCK) {
+      size_t i1 = std::min(n, i0 + BLOCK);
+      bool diff = false;
+      for (size_t i = i0; i < i1; ++i)
+        diff |= !(a[i] == b[i]);
+      if (diff) return false;
+    }
+    return true;
+  }
+
+  // |a - b| <= atol + rtol * |b| поэлементно; NaN не равен ничему
+  template<typename T>
+  bool approx_equal(const T* a, const T* b, size_t n, T rtol, T atol)
+  {
+    for (size_t i0 = 0; i0 < n; i0 += BLOCK) {
+      size_t i1 = std::min(n, i0 + BLOCK);
+      bool diff = false;
+      for (size_t i = i0; i < i1; ++i) {
+        T d = a[i] < b[i] ? b[i] - a[i] : a[i] - b[i];
+        T mag = b[i] < T() ? -b[i] : b[i];
+        diff |= !(d <= atol + rtol * mag);
+      }
+      if (diff) return false;
+    }
+    return true;
+  }
+}
+
+template<typename T>
+class TProductCache;   // tcache.h, подключается в конце файла
+template<typename T>
+struct TPlusTimes;     // tsemiring.h, подключается в конце файла
+
 // Динамический вектор - 
 // шаблонный вектор на динамической памяти
 template<typename T>
 class TDynamicVector {
 protected:
+  // число элементов, помещающихся во встроенный буфер
+  static constexpr size_t INLINE_CAPACITY = std::is_trivially_copyable<T>::value
+    ? TDYNAMIC_VECTOR_INLINE_BYTES / sizeof(T) : 0;
+  static constexpr size_t INLINE_SLOTS = INLINE_CAPACITY ? INLINE_CAPACITY : 1;
+
+  // байт данных на элемент для счётчиков: у вложенных векторов
+  // данные учитываются самими вложенными векторами
+  static constexpr size_t ELEM_BYTES = std::is_trivially_copyable<T>::value ? sizeof(T) : 0;
+
   size_t sz;
   T* pMem;
+  // хеш содержимого (0 - не вычислен) и версия, для которой он
+  // вычислен: хеш действителен, пока версия не изменилась. Атомарные,
+  // так как константный hash() может вызываться из нескольких потоков сразу
+  mutable std::atomic<uint64_t> hashCache{0};
+  mutable std::atomic<uint64_t> hashVer{0};
+  // номер версии содержимого, увеличивается при каждом изменении
+  uint64_t ver = 0;
+  typename std::conditional<(INLINE_CAPACITY != 0), T[INLINE_SLOTS], char>::type inlineMem;
+
+  // отметить изменение содержимого; сохранённый хеш при этом перестаёт
+  // соответствовать версии, поэтому поэлементная запись стоит одного
+  // инкремента
+  void touch() noexcept
+  {
+      ++ver;
+  }
+
+  // хеш текущей версии или 0
+  uint64_t cached_hash() const noexcept
+  {
+      return hashVer.load(std::memory_order_acquire) == ver ? hashCache.load(std::memory_order_relaxed) : 0;
+  }
+
+  void set_cached_hash(uint64_t h) const noexcept
+  {
+      hashCache.store(h, std::memory_order_relaxed);
+      hashVer.store(ver, std::memory_order_release);
+  }
+
+  T* local() noexcept { return reinterpret_cast<T*>(&inlineMem); }
+  bool is_inline() const noexcept { return INLINE_CAPACITY > 0 && pMem == reinterpret_cast<const T*>(&inlineMem); }
+
+  // память под n элементов: встроенный буфер или куча
+  T* allocate(size_t n)
+  {
+      if (n <= INLINE_CAPACITY) return local();
+      TMATRIX_COUNT_ALLOC(n * sizeof(T));
+      return new T[n];
+  }
+
+  void release() noexcept
+  {
+      if (pMem != nullptr && !is_inline())
+          delete[] pMem;
+      pMem = nullptr;
+  }
+
+  // забрать содержимое v, оставив его пустым
+  void steal(TDynamicVector& v) noexcept
+  {
+      sz = v.sz;
+      ++ver;
+      set_cached_hash(v.cached_hash());
+      v.touch();
+      if (v.is_inline()) {
+          pMem = local();
+          std::copy(v.pMem, v.pMem + sz, pMem);
+      }
+      else {
+          pMem = v.pMem;
+      }
+      v.sz = 0;
+      v.pMem = nullptr;
+  }
+
+  static constexpr size_t SUM_LANES = 8;       // число аккумуляторов в режиме Fast
+  static constexpr size_t PAIRWISE_BLOCK = 128; // размер листа попарного суммирования
+
+  // f(i) - i-е слагаемое
+  template<typename F>
+  static T reduce_fast(F f, size_t lo, size_t hi)
+  {
+      T acc[SUM_LANES];
+      for (size_t l = 0; l < SUM_LANES; ++l) acc[l] = T();
+      size_t i = lo, full = lo + (hi - lo) / SUM_LANES * SUM_LANES;
+      for (; i < full; i += SUM_LANES) {
+          for (size_t l = 0; l < SUM_LANES; ++l)
+              acc[l] += f(i + l);
+      }
+      for (; i < hi; ++i) acc[0] += f(i);
+      for (size_t l = SUM_LANES / 2; l > 0; l /= 2)
+          for (size_t k = 0; k < l; ++k)
+              acc[k] += acc[k + l];
+      return acc[0];
+  }
+
+  template<typename F>
+  static T reduce_pairwise(F f, size_t lo, size_t hi)
+  {
+      if (hi - lo <= PAIRWISE_BLOCK) return reduce_fast(f, lo, hi);
+      size_t mid = lo + (hi - lo) / 2;
+      return reduce_pairwise(f, lo, mid) + reduce_pairwise(f, mid, hi);
+  }
+
+  template<typename F>
+  static T reduce_kahan(F f, size_t lo, size_t hi)
+  {
+      T s = T(), c = T();
+      for (size_t i = lo; i < hi; ++i) {
+          T y = f(i) - c;
+          T t = s + y;
+          c = (t - s) - y;
+          s = t;
+      }
+      return s;
+  }
+
+  static constexpr size_t PARALLEL_CHUNK = 16384; // размер блока параллельной редукции
+
+  template<typename F>
+  static T reduce_parallel(F f, size_t n, bool reproducible)
+  {
+      size_t chunks = (n + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+      if (chunks <= 1) return reduce_fast(f, 0, n);
+
+      T* partial = new T[chunks];
+      T s = T();
+#pragma omp parallel for if(chunks >= 4)
+      for (long long c = 0; c < static_cast<long long>(chunks); ++c) {
+          size_t lo = static_cast<size_t>(c) * PARALLEL_CHUNK;
+          size_t hi = lo + PARALLEL_CHUNK < n ? lo + PARALLEL_CHUNK : n;
+          T p = reduce_fast(f, lo, hi);
+          if (reproducible) {
+              partial[c] = p;
+          }
+          else {
+#pragma omp critical
+              s += p;
+          }
+      }
+      if (reproducible) {
+          for (size_t step = 1; step < chunks; step *= 2)
+              for (size_t c = 0; c + step < chunks; c += 2 * step)
+                  partial[c] += partial[c + step];
+          s = partial[0];
+      }
+      delete[] partial;
+      return s;
+  }
+
+  template<typename F>
+  static T reduce(F f, size_t n, TSumMode mode)
+  {
+      switch (mode) {
+      case TSumMode::Pairwise: return reduce_pairwise(f, 0, n);
+      case TSumMode::Kahan: return reduce_kahan(f, 0, n);
+      case TSumMode::Parallel: return reduce_parallel(f, n, false);
+      case TSumMode::Reproducible: return reduce_parallel(f, n, true);
+      default: return reduce_fast(f, 0, n);
+      }
+  }
 
 public:
   TDynamicVector(size_t size = 1) : sz(size)
   {
     if (sz == 0) throw out_of_range("Vector size should be greater than zero");
     if (sz > MAX_VECTOR_SIZE) throw out_of_range("Vector size should be less than the maximum");
-    pMem = new T[sz]();
+    if (sz <= INLINE_CAPACITY) {
+      pMem = local();
+      std::fill(pMem, pMem + sz, T());
+    }
+    else {
+      TMATRIX_COUNT_ALLOC(sz * sizeof(T));
+      pMem = new T[sz]();
+    }
   }
 
   TDynamicVector(T* arr, size_t s) : sz(s)
   {
     assert(arr != nullptr && "TDynamicVector ctor requires non-nullptr arg");
-    pMem = new T[sz];
+    pMem = allocate(sz);
     copy(arr, arr + sz, pMem);
   }
 
@@ -44,26 +302,23 @@ public:
           pMem = nullptr;
           return;
       }
-      pMem = new T[sz];
+      TMATRIX_SCOPED_OP(TOpKind::Copy, 0, 2 * sz * ELEM_BYTES);
+      TMATRIX_TRACE_TOP("copy");
+      pMem = allocate(sz);
       for (size_t i = 0; i < sz; ++i) {
           pMem[i] = v.pMem[i];
       } 
+      set_cached_hash(v.cached_hash());
   }
 
   TDynamicVector(TDynamicVector&& v) noexcept
   {
-      sz = v.sz;
-      pMem = v.pMem;
-      v.sz = 0;
-      v.pMem = nullptr;
+      steal(v);
   }
 
   ~TDynamicVector()
   {
-      if (pMem != nullptr) {
-          delete[] pMem;
-          pMem = nullptr;
-      }
+      release();
   }
 
   TDynamicVector& operator=(const TDynamicVector& v)
@@ -71,23 +326,25 @@ public:
       if (this == &v) return *this;
 
       if (v.sz == 0) {
-          if (pMem != nullptr) 
-              delete[] pMem;
-
-          pMem = nullptr;
+          release();
           sz = 0;
+          touch();
 
           return *this;
       }
       
-      T* newMem = new T[v.sz];
+      TMATRIX_SCOPED_OP(TOpKind::Copy, 0, 2 * v.sz * ELEM_BYTES);
+      TMATRIX_TRACE_TOP("copy");
+      T* newMem = allocate(v.sz);
       for (size_t i = 0; i < v.sz; i++) {
           newMem[i] = v.pMem[i];
       }
 
-      delete[] pMem;
+      if (pMem != newMem) release();
       pMem = newMem;
       sz = v.sz;
+      ++ver;
+      set_cached_hash(v.cached_hash());
 
       return *this;
   }
@@ -95,22 +352,18 @@ public:
   TDynamicVector& operator=(TDynamicVector&& v) noexcept
   {
       if (this == &v) return *this;
-      if (pMem != nullptr) delete[] pMem;
-
-      pMem = v.pMem;
-      sz = v.sz;
-
-      v.pMem = nullptr;
-      v.sz = 0;
+      release();
+      steal(v);
       
       return *this;
   }
 
   size_t size() const noexcept { return sz; }
 
-  // индексация
+  // индексация; неконстантный доступ считает вектор изменённым
   T& operator[](size_t ind)
   {
+      touch();
       return pMem[ind];
   }
 
@@ -123,6 +376,7 @@ public:
   T& at(size_t ind)
   {
       if (ind >= sz) throw out_of_range("Index out of range");
+      touch();
       return pMem[ind];
   }
 
@@ -136,10 +390,7 @@ public:
   bool operator==(const TDynamicVector& v) const noexcept
   {
       if (sz != v.sz) return false;
-      for (size_t i = 0; i < sz; ++i) {
-          if (!(pMem[i] == v.pMem[i])) return false;
-      }
-      return true;
+      return compare_detail::equal(pMem, v.pMem, sz);
   }
 
   bool operator!=(const TDynamicVector& v) const noexcept
@@ -150,27 +401,36 @@ public:
   // скалярные операции
   TDynamicVector operator+(T val)
   {
+      TMATRIX_SCOPED_OP(TOpKind::ScalarMul, sz, 2 * sz * ELEM_BYTES);
+      TMATRIX_TRACE_TOP("vector_scalar");
       TDynamicVector<T> result(sz);
+      T* out = result.pMem;
       for (size_t i = 0; i < sz; ++i) {
-          result[i] = pMem[i] + val;
+          out[i] = pMem[i] + val;
       }
       return result;
   }
 
   TDynamicVector operator-(T val)
   {
+      TMATRIX_SCOPED_OP(TOpKind::ScalarMul, sz, 2 * sz * ELEM_BYTES);
+      TMATRIX_TRACE_TOP("vector_scalar");
       TDynamicVector<T> result(sz);
+      T* out = result.pMem;
       for (size_t i = 0; i < sz; ++i) {
-          result[i] = pMem[i] - val;
+          out[i] = pMem[i] - val;
       }
       return result;
   }
 
   TDynamicVector operator*(T val)
   {
+      TMATRIX_SCOPED_OP(TOpKind::ScalarMul, sz, 2 * sz * ELEM_BYTES);
+      TMATRIX_TRACE_TOP("vector_scalar");
       TDynamicVector<T> result(sz);
+      T* out = result.pMem;
       for (size_t i = 0; i < sz; ++i) {
-          result[i] = pMem[i] * val;
+          out[i] = pMem[i] * val;
       }
       return result;
   }
@@ -179,11 +439,14 @@ public:
   TDynamicVector operator+(const TDynamicVector& v)
   {
       if (sz != v.sz) throw out_of_range("Vectors are of different sizes");
+      TMATRIX_SCOPED_OP(TOpKind::Add, sz, 3 * sz * ELEM_BYTES);
+      TMATRIX_TRACE_TOP("vector_add");
       if (sz == 0) return TDynamicVector(*this);
 
       TDynamicVector<T> result(sz);
+      T* out = result.pMem;
       for (size_t i = 0; i < sz; ++i) {
-          result[i] = pMem[i] + v.pMem[i];
+          out[i] = pMem[i] + v.pMem[i];
       }
       return result;
   }
@@ -191,36 +454,95 @@ public:
   TDynamicVector operator-(const TDynamicVector& v)
   {
       if (sz != v.sz) throw out_of_range("Vectors are of different sizes");
+      TMATRIX_SCOPED_OP(TOpKind::Sub, sz, 3 * sz * ELEM_BYTES);
+      TMATRIX_TRACE_TOP("vector_sub");
       if (sz == 0) return TDynamicVector(*this);
 
       TDynamicVector<T> result(sz);
+      T* out = result.pMem;
       for (size_t i = 0; i < sz; ++i) {
-          result[i] = pMem[i] - v.pMem[i];
+          out[i] = pMem[i] - v.pMem[i];
       }
       return result;
   }
 
   T operator*(const TDynamicVector& v)
+  {
+      return dot(v);
+  }
+
+  // скалярное произведение с выбором способа суммирования
+  T dot(const TDynamicVector& v, TSumMode mode = TSumMode::Fast) const
   {
       if (sz != v.sz) throw out_of_range("Vectors are of different sizes");
-      if (sz == 0) return 0;
+      TMATRIX_SCOPED_OP(TOpKind::Dot, 2 * sz, 2 * sz * ELEM_BYTES);
+      const T* a = pMem;
+      const T* b = v.pMem;
+      return reduce([a, b](size_t i) { return a[i] * b[i]; }, sz, mode);
+  }
 
-      T result = T() ;
-      for (size_t i = 0; i < sz; ++i) {
-          result += pMem[i] * v.pMem[i];
+  // сумма элементов
+  T sum(TSumMode mode = TSumMode::Fast) const
+  {
+      TMATRIX_SCOPED_OP(TOpKind::Dot, sz, sz * ELEM_BYTES);
+      const T* a = pMem;
+      return reduce([a](size_t i) { return a[i]; }, sz, mode);
+  }
+
+  // евклидова норма
+  T norm(TSumMode mode = TSumMode::Fast) const
+  {
+      return std::sqrt(dot(*this, mode));
+  }
+
+  // 64-битный хеш содержимого, согласованный с ==: вычисляется один раз
+  // и хранится, пока не изменится версия. Версию меняют неконстантный
+  // доступ (в момент получения ссылки, а не записи по ней) и изменяющие
+  // операции, поэтому запись по ссылке, полученной до вызова hash(),
+  // оставляет прежний хеш. Сравнение == хешем не пользуется
+  uint64_t hash() const
+  {
+      uint64_t h = cached_hash();
+      if (!h) {
+          h = hash_detail::hash_array(pMem, sz);
+          h = h ? h : 1;
+          set_cached_hash(h);
       }
-      return result;
+      return h;
   }
 
+  // версия содержимого: растёт при каждом неконстантном доступе и
+  // изменяющей операции (с той же оговоркой о ссылках, что и у hash),
+  // копия начинает с нуля. Сравнима только с версиями того же объекта;
+  // вычисленное по вектору можно не пересчитывать, пока она не изменилась
+  uint64_t version() const noexcept { return ver; }
+
+  // хранится ли вектор во встроенном буфере
+  bool is_small() const noexcept { return is_inline(); }
+
   friend void swap(TDynamicVector& lhs, TDynamicVector& rhs) noexcept
   {
-    std::swap(lhs.sz, rhs.sz);
-    std::swap(lhs.pMem, rhs.pMem);
+    if (!lhs.is_inline() && !rhs.is_inline()) {
+      std::swap(lhs.sz, rhs.sz);
+      std::swap(lhs.pMem, rhs.pMem);
+      uint64_t lh = lhs.cached_hash(), rh = rhs.cached_hash();
+      ++lhs.ver;
+      ++rhs.ver;
+      lhs.set_cached_hash(rh);
+      rhs.set_cached_hash(lh);
+      return;
+    }
+    TDynamicVector tmp(std::move(lhs));
+    lhs = std::move(rhs);
+    rhs = std::move(tmp);
   }
 
   // ввод/вывод
   friend istream& operator>>(istream& istr, TDynamicVector& v)
   {
+    TMATRIX_SCOPED_OP(TOpKind::IO, 0, v.sz * ELEM_BYTES);
+    TMATRIX_TRACE_TOP("vector_io");
+    v.touch();
     for (size_t i = 0; i < v.sz; i++)
       istr >> v.pMem[i]; 
     return istr;
@@ -228,6 +550,8 @@ public:
 
   friend ostream& operator<<(ostream& ostr, const TDynamicVector& v)
   {
+    TMATRIX_SCOPED_OP(TOpKind::IO, 0, v.sz * ELEM_BYTES);
+    TMATRIX_TRACE_TOP("vector_io");
       ostr << v.pMem[0];
       for (size_t i = 1; i < v.sz; ++i) {
           ostr << " " << v.pMem[i];
@@ -236,6 +560,242 @@ public:
   }
 };
 
+// Транспонирование над массивами указателей на строки: кэш-независимая
+// рекурсия делит больший из размеров блока пополам, пока блок не станет
+// листом LEAF x LEAF, который целиком помещается в L1
+namespace transpose_detail
+{
+  const size_t LEAF = 16;
+  const size_t PARALLEL_TILE = 256;   // плитка для распределения по потокам
+
+  // dst[j][i] = src[i][j] для i из [i0, i1), j из [j0, j1)
+  template<typename T>
+  void copy_block(const T* const* src, T* const* dst, size_t i0, size_t i1, size_t j0, size_t j1)
+  {
+    if (i1 - i0 <= LEAF && j1 - j0 <= LEAF) {
+      for (size_t i = i0; i < i1; ++i) {
+        const T* row = src[i];
+        for (size_t j = j0; j < j1; ++j)
+          dst[j][i] = row[j];
+      }
+    }
+    else if (i1 - i0 >= j1 - j0) {
+      size_t mid = i0 + (i1 - i0) / 2;
+      copy_block(src, dst, i0, mid, j0, j1);
+      copy_block(src, dst, mid, i1, j0, j1);
+    }
+    else {
+      size_t mid = j0 + (j1 - j0) / 2;
+      copy_block(src, dst, i0, i1, j0, mid);
+      copy_block(src, dst, i0, i1, mid, j1);
+    }
+  }
+
+  // обмен a[i][j] и a[j][i] для блока, не пересекающего диагональ
+  template<typename T>
+  void swap_block(T* const* a, size_t i0, size_t i1, size_t j0, size_t j1)
+  {
+    if (i1 - i0 <= LEAF && j1 - j0 <= LEAF) {
+      for (size_t i = i0; i < i1; ++i)
+        for (size_t j = j0; j < j1; ++j)
+          std::swap(a[i][j], a[j][i]);
+    }
+    else if (i1 - i0 >= j1 - j0) {
+      size_t mid = i0 + (i1 - i0) / 2;
+      swap_block(a, i0, mid, j0, j1);
+      swap_block(a, mid, i1, j0, j1);
+    }
+    else {
+      size_t mid = j0 + (j1 - j0) / 2;
+      swap_block(a, i0, i1, j0, mid);
+      swap_block(a, i0, i1, mid, j1);
+    }
+  }
+
+  // транспонирование диагонального блока [lo, hi) x [lo, hi) на месте
+  template<typename T>
+  void transpose_diagonal(T* const* a, size_t lo, size_t hi)
+  {
+    if (hi - lo <= LEAF) {
+      for (size_t i = lo + 1; i < hi; ++i)
+        for (size_t j = lo; j < i; ++j)
+          std::swap(a[i][j], a[j][i]);
+      return;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    transpose_diagonal(a, lo, mid);
+    transpose_diagonal(a, mid, hi);
+    swap_block(a, mid, hi, lo, mid);
+  }
+
+  // квадратная матрица n x n на месте; пара плиток (bi, bj), bj <= bi,
+  // обрабатывается потоком плитки bi, поэтому потоки не пересекаются
+  template<typename T>
+  void transpose_square(T* const* a, size_t n)
+  {
+    long long tiles = static_cast<long long>((n + PARALLEL_TILE - 1) / PARALLEL_TILE);
+#pragma omp parallel for schedule(dynamic) if(n >= 2 * PARALLEL_TILE)
+    for (long long bi = 0; bi < tiles; ++bi) {
+      size_t i0 = static_cast<size_t>(bi) * PARALLEL_TILE, i1 = std::min(n, i0 + PARALLEL_TILE);
+      for (size_t j0 = 0; j0 < i0; j0 += PARALLEL_TILE)
+        swap_block(a, i0, i1, j0, j0 + PARALLEL_TILE);
+      transpose_diagonal(a, i0, i1);
+    }
+  }
+
+  // прямоугольный блок rows x cols из src в dst (cols x rows)
+  template<typename T>
+  void transpose_copy(const T* const* src, T* const* dst, size_t rows, size_t cols)
+  {
+    long long tiles = static_cast<long long>((rows + PARALLEL_TILE - 1) / PARALLEL_TILE);
+#pragma omp parallel for if(rows * cols >= 4 * PARALLEL_TILE * PARALLEL_TILE)
+    for (long long bi = 0; bi < tiles; ++bi) {
+      size_t i0 = static_cast<size_t>(bi) * PARALLEL_TILE, i1 = std::min(rows, i0 + PARALLEL_TILE);
+      copy_block(src, dst, i0, i1, size_t(0), cols);
+    }
+  }
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TMATRIX_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define TMATRIX_PREFETCH(p) ((void)0)
+#endif
+
+// Произведение матрицы на вектор по массиву строк. Каждая строка
+// суммируется аккумуляторами режима TSumMode::Fast, поэтому результат
+// побитово совпадает со скалярным произведением строки на x при любом
+// числе потоков. Строки - отдельные выделения памяти, и аппаратная
+// предвыборка не видит начало следующей строки, поэтому оно
+// запрашивается заранее
+namespace gemv_detail
+{
+  const size_t ROWS = 4;            // строк за проход в A * x и x^T * A
+  const size_t LANES = 8;           // аккумуляторов на строку, как SUM_LANES
+  const size_t ROW_BLOCK = 64;      // строк на задачу параллельного цикла
+  const size_t COLUMN_BLOCK = 1024; // отрезок y на задачу в x^T * A
+  const size_t PREFETCH_BYTES = 256;
+
+  template<typename T>
+  void prefetch_row(const T* row, size_t n)
+  {
+    const char* p = reinterpret_cast<const char*>(row);
+    size_t bytes = std::min(n * sizeof(T), PREFETCH_BYTES);
+    for (size_t b = 0; b < bytes; b += 64)
+      TMATRIX_PREFETCH(p + b);
+  }
+
+  // alpha * (r, x) + beta * out
+  template<typename T>
+  T dot_row(const T* r, const T* x, size_t n, T alpha, T beta, T out)
+  {
+    T a[LANES];
+    for (size_t l = 0; l < LANES; ++l) a[l] = T();
+    size_t j = 0, full = n / LANES * LANES;
+    for (; j < full; j += LANES)
+      for (size_t l = 0; l < LANES; ++l)
+        a[l] += r[j + l] * x[j + l];
+    for (; j < n; ++j)
+      a[0] += r[j] * x[j];
+    for (size_t l = LANES / 2; l > 0; l /= 2)
+      for (size_t k = 0; k < l; ++k)
+        a[k] += a[k + l];
+    T s = alpha * a[0];
+    return beta == T() ? s : s + beta * out;
+  }
+
+  // dot_row для ROWS строк за один проход: каждый отрезок x читается
+  // один раз на группу строк. Порядок сложения в каждой строке тот же,
+  // что в dot_row. omp simd оставляет векторизацию циклу по LANES:
+  // без неё GCC векторизует внешний цикл с перестановками и ядро
+  // медленнее однострочного (нужен OpenMP или -fopenmp-simd)
+  template<typename T>
+  void dot_rows(const TDynamicVector<T>* rows, const T* x, size_t n, T alpha, T beta, T* out)
+  {
+    const T* r0 = &rows[0][0];
+    const T* r1 = &rows[1][0];
+    const T* r2 = &rows[2][0];
+    const T* r3 = &rows[3][0];
+    T a0[LANES], a1[LANES], a2[LANES], a3[LANES];
+    for (size_t l = 0; l < LANES; ++l) a0[l] = a1[l] = a2[l] = a3[l] = T();
+    size_t j = 0, full = n / LANES * LANES;
+    for (; j < full; j += LANES)
+#pragma omp simd
+      for (size_t l = 0; l < LANES; ++l) {
+        a0[l] += r0[j + l] * x[j + l];
+        a1[l] += r1[j + l] * x[j + l];
+        a2[l] += r2[j + l] * x[j + l];
+        a3[l] += r3[j + l] * x[j + l];
+      }
+    for (size_t k = j; k < n; ++k) {
+      a0[0] += r0[k] * x[k];
+      a1[0] += r1[k] * x[k];
+      a2[0] += r2[k] * x[k];
+      a3[0] += r3[k] * x[k];
+    }
+    for (size_t l = LANES / 2; l > 0; l /= 2)
+      for (size_t k = 0; k < l; ++k) {
+        a0[k] += a0[k + l];
+        a1[k] += a1[k + l];
+        a2[k] += a2[k + l];
+        a3[k] += a3[k + l];
+      }
+    T s[ROWS] = { alpha * a0[0], alpha * a1[0], alpha * a2[0], alpha * a3[0] };
+    for (size_t q = 0; q < ROWS; ++q)
+      out[q] = beta == T() ? s[q] : s[q] + beta * out[q];
+  }
+
+  // y = alpha * A * x + beta * y, A задана массивом n строк длины n;
+  // внутри блока строки идут группами по ROWS
+  template<typename T>
+  void gemv(const TDynamicVector<T>* rows, size_t n, const T* x, T alpha, T beta, T* y)
+  {
+    long long blocks = static_cast<long long>((n + ROW_BLOCK - 1) / ROW_BLOCK);
+#pragma omp parallel for schedule(static) if(n >= 128)
+    for (long long blk = 0; blk < blocks; ++blk) {
+      size_t i0 = static_cast<size_t>(blk) * ROW_BLOCK, i1 = std::min(n, i0 + ROW_BLOCK);
+      size_t i = i0;
+      for (; i + ROWS <= i1; i += ROWS) {
+        for (size_t q = i + ROWS; q < std::min(i1, i + 2 * ROWS); ++q)
+          prefetch_row(&rows[q][0], n);
+        dot_rows(rows + i, x, n, alpha, beta, y + i);
+      }
+      for (; i < i1; ++i)
+        y[i] = dot_row(&rows[i][0], x, n, alpha, beta, y[i]);
+    }
+  }
+
+  // y = alpha * A^T * x + beta * y (то же, что x^T * A): потоки делят y на
+  // отрезки по COLUMN_BLOCK, внутри отрезка строки A добавляются группами
+  // по ROWS, так что y читается и пишется один раз на группу строк
+  template<typename T>
+  void gemv_transposed(const TDynamicVector<T>* rows, size_t n, const T* x, T alpha, T beta, T* y)
+  {
+    long long chunks = static_cast<long long>((n + COLUMN_BLOCK - 1) / COLUMN_BLOCK);
+#pragma omp parallel for if(n >= 256)
+    for (long long ch = 0; ch < chunks; ++ch) {
+      size_t j0 = static_cast<size_t>(ch) * COLUMN_BLOCK, j1 = std::min(n, j0 + COLUMN_BLOCK);
+      for (size_t j = j0; j < j1; ++j)
+        y[j] = beta == T() ? T() : beta * y[j];
+      size_t k = 0;
+      for (; k + ROWS <= n; k += ROWS) {
+        const T* r0 = &rows[k][0];
+        const T* r1 = &rows[k + 1][0];
+        const T* r2 = &rows[k + 2][0];
+        const T* r3 = &rows[k + 3][0];
+        T s0 = alpha * x[k], s1 = alpha * x[k + 1], s2 = alpha * x[k + 2], s3 = alpha * x[k + 3];
+        for (size_t j = j0; j < j1; ++j)
+          y[j] += s0 * r0[j] + s1 * r1[j] + s2 * r2[j] + s3 * r3[j];
+      }
+      for (; k < n; ++k) {
+        const T* rk = &rows[k][0];
+        T s = alpha * x[k];
+        for (size_t j = j0; j < j1; ++j)
+          y[j] += s * rk[j];
+      }
+    }
+  }
+}
 
 // Динамическая матрица - 
 // шаблонная матрица на динамической памяти
@@ -244,21 +804,155 @@ class TDynamicMatrix : private TDynamicVector<TDynamicVector<T>>
 {
   using TDynamicVector<TDynamicVector<T>>::pMem;
   using TDynamicVector<TDynamicVector<T>>::sz;
+  using TDynamicVector<TDynamicVector<T>>::ver;
+
+  // отметки строк, к которым был неконстантный доступ; пустой - учёт
+  // не ведётся. По байту на строку, а не по биту: параллельные циклы
+  // обращаются к разным строкам из разных потоков, и запись в общее
+  // слово битовой карты была бы гонкой. Тип отметки - перечисление, а
+  // не unsigned char: запись через unsigned char может изменить любой
+  // объект, и компилятор перечитывал бы всё в циклах по m[i][j]
+  enum TRowMark : unsigned char { Clean = 0, Dirty = 1 };
+  std::vector<TRowMark> dirtyRows;
+
+  // без учёта отметка пишется в заглушку потока: безусловная запись по
+  // неизменному в цикле адресу выносится компилятором из циклов по m[i][j],
+  // а условная мешала бы их векторизации
+  void mark_dirty(size_t i) noexcept
+  {
+      thread_local TRowMark sink;
+      bool on = !dirtyRows.empty();
+      TRowMark* marks = on ? dirtyRows.data() : &sink;
+      marks[on ? i : 0] = Dirty;
+  }
+
+  void mark_all_dirty()
+  {
+      if (!dirtyRows.empty())
+          dirtyRows.assign(sz, Dirty);
+  }
 
 public:
   TDynamicMatrix(size_t s = 1) : TDynamicVector<TDynamicVector<T>>(s)
   {
+      TMATRIX_TRACE("matrix_construct");
       if (sz == 0) throw out_of_range("Vector size should be greater than zero");
       if (sz > MAX_MATRIX_SIZE) throw out_of_range("Vector size should be less than the maximum");
       for (size_t i = 0; i < sz; i++)
         pMem[i] = TDynamicVector<T>(sz);
   }
 
+  TDynamicMatrix(const TDynamicMatrix& m) = default;
+  TDynamicMatrix(TDynamicMatrix&& m) noexcept = default;
+
+  // присваивание заменяет все строки; учёт изменённых строк у
+  // левого операнда сохраняется, и все его строки считаются изменёнными
+  TDynamicMatrix& operator=(const TDynamicMatrix& m)
+  {
+      if (this == &m) return *this;
+      uint64_t before = version();
+      TDynamicVector<TDynamicVector<T>>::operator=(m);
+      ver = before + 1;
+      mark_all_dirty();
+      return *this;
+  }
+
+  TDynamicMatrix& operator=(TDynamicMatrix&& m) noexcept
+  {
+      if (this == &m) return *this;
+      uint64_t before = version();
+      TDynamicVector<TDynamicVector<T>>::operator=(std::move(m));
+      ver = before + 1;
+      // без выделения памяти: если отметкам не хватает ёмкости, берётся
+      // буфер источника, а если мал и он, учёт прекращается - без учёта
+      // все строки и так считаются изменёнными
+      if (!dirtyRows.empty()) {
+          if (dirtyRows.capacity() < sz) {
+              dirtyRows.swap(m.dirtyRows);
+              m.dirtyRows.clear();
+          }
+          if (dirtyRows.capacity() < sz)
+              dirtyRows.clear();
+          else
+              dirtyRows.assign(sz, Dirty);
+      }
+      return *this;
+  }
+
   size_t size() const noexcept { return sz; } 
 
   using TDynamicVector<TDynamicVector<T>>::operator[];
   using TDynamicVector<TDynamicVector<T>>::at;
 
+  // неконстантный доступ к строке отмечает её изменённой. Версию массива
+  // строк он не меняет: запись в строку меняет версию самой строки, и
+  // m[i][j] = x стоит одного инкремента, как у вектора
+  TDynamicVector<T>& operator[](size_t ind)
+  {
+      mark_dirty(ind);
+      return pMem[ind];
+  }
+
+  TDynamicVector<T>& at(size_t ind)
+  {
+      if (ind >= sz) throw out_of_range("Index out of range");
+      mark_dirty(ind);
+      return pMem[ind];
+  }
+
+  // версия матрицы - сумма версий строк и массива строк, поэтому
+  // учитывает и запись через ранее полученные ссылки на строки; O(n).
+  // Присваивание заменяет строки новыми, и версия массива строк
+  // переносит прежнюю сумму, чтобы версия не уменьшалась
+  uint64_t version() const noexcept
+  {
+      uint64_t v = ver;
+      for (size_t i = 0; i < sz; ++i)
+          v += pMem[i].version();
+      return v;
+  }
+
+  // Учёт изменённых строк для инкрементального пересчёта: после
+  // включения строка считается изменённой, если к ней был неконстантный
+  // доступ через operator[] или at матрицы либо матрица изменялась целиком
+  void track_dirty_rows(bool on = true)
+  {
+      if (!on)
+          dirtyRows.clear();
+      else if (dirtyRows.empty())
+          dirtyRows.assign(sz, Clean);
+  }
+
+  bool tracks_dirty_rows() const noexcept { return !dirtyRows.empty(); }
+
+  // без учёта любая строка считается изменённой
+  bool row_dirty(size_t i) const
+  {
+      if (i >= sz) throw out_of_range("Index out of range");
+      return dirtyRows.empty() || dirtyRows[i] == Dirty;
+  }
+
+  size_t dirty_row_count() const
+  {
+      if (dirtyRows.empty()) return sz;
+      return static_cast<size_t>(std::count(dirtyRows.begin(), dirtyRows.end(), Dirty));
+  }
+
+  void clear_dirty_rows() noexcept
+  {
+      std::fill(dirtyRows.begin(), dirtyRows.end(), Clean);
+  }
+
+  // хеш содержимого по хешам строк, см. TDynamicVector::hash. На уровне
+  // матрицы не хранится: запись через ранее полученную ссылку на строку
+  // сбрасывает только хеш строки, поэтому хеши строк (они хранятся)
+  // объединяются заново при каждом вызове, O(n)
+  uint64_t hash() const
+  {
+      uint64_t h = hash_detail::hash_array(static_cast<const TDynamicVector<T>*>(pMem), sz);
+      return h ? h : 1;
+  }
+
   // сравнение
   bool operator==(const TDynamicMatrix& m) const noexcept
   {
@@ -269,25 +963,72 @@ public:
       return true;
   }
 
+  // транспонирование на месте
+  TDynamicMatrix& transpose()
+  {
+      TMATRIX_SCOPED_OP(TOpKind::Copy, 0, 2 * sz * sz * sizeof(T));
+      TMATRIX_TRACE("transpose");
+      TDynamicVector<T*> rows = row_pointers();
+      transpose_detail::transpose_square(&rows[0], sz);
+      return *this;
+  }
+
+  TDynamicMatrix transposed() const
+  {
+      TDynamicMatrix result(sz);
+      TMATRIX_SCOPED_OP(TOpKind::Copy, 0, 2 * sz * sz * sizeof(T));
+      TMATRIX_TRACE("transpose");
+      TDynamicVector<const T*> src = row_pointers();
+      TDynamicVector<T*> dst = result.row_pointers();
+      transpose_detail::transpose_copy(&src[0], &dst[0], sz, sz);
+      return result;
+  }
+
   // матрично-скалярные операции
   TDynamicMatrix operator*(const T& val)
   {
+      TMATRIX_SCOPED_OP(TOpKind::ScalarMul, 0, 0);
+      TMATRIX_TRACE("matrix_scalar_mul");
       TDynamicMatrix result(sz);
       for (size_t i = 0; i < sz; ++i) {
           result.pMem[i] = pMem[i] * val;
       }
-      return *this;
+      return result;
   }
 
   // матрично-векторные операции
   TDynamicVector<T> operator*(const TDynamicVector<T>& v)
+  {
+      return multiply(v);
+  }
+
+  // произведение на вектор с параллельной обработкой строк; каждая строка
+  // суммируется одним потоком, поэтому в режимах Fast, Pairwise, Kahan и
+  // Reproducible результат не зависит от числа потоков
+  TDynamicVector<T> multiply(const TDynamicVector<T>& v, TSumMode mode = TSumMode::Fast) const
   {
       if (sz != v.size()) throw out_of_range("Matrix and vector sizes are incompatible");
+      TProductCache<T>* cache = TProductCache<T>::installed();
+      if (!cache) return multiply_uncached(v, mode);
 
-      TDynamicVector<T> result(sz);
-      for (size_t i = 0; i < sz; ++i) {
-          result[i] = pMem[i] * v;
-      }
+      auto key = TProductCache<T>::gemv_key(*this, v, mode);
+      if (auto hit = cache->find_vector(key, *this, v)) return *hit;
+      TDynamicVector<T> result = multiply_uncached(v, mode);
+      cache->insert(key, *this, v, result);
+      return result;
+  }
+
+  // произведение вектора-строки на матрицу x^T * A
+  TDynamicVector<T> left_multiply(const TDynamicVector<T>& x) const
+  {
+      if (sz != x.size()) throw out_of_range("Matrix and vector sizes are incompatible");
+      TProductCache<T>* cache = TProductCache<T>::installed();
+      if (!cache) return left_multiply_uncached(x);
+
+      auto key = TProductCache<T>::left_gemv_key(*this, x);
+      if (auto hit = cache->find_vector(key, *this, x)) return *hit;
+      TDynamicVector<T> result = left_multiply_uncached(x);
+      cache->insert(key, *this, x, result);
       return result;
   }
 
@@ -295,6 +1036,8 @@ public:
   TDynamicMatrix operator+(const TDynamicMatrix& m)
   {
       if (sz != m.sz) throw out_of_range("Matrices have different sizes");
+      TMATRIX_SCOPED_OP(TOpKind::Add, 0, 0);
+      TMATRIX_TRACE("matrix_add");
 
       TDynamicMatrix result(sz);
       for (size_t i = 0; i < sz; ++i) {
@@ -308,6 +1051,8 @@ public:
   TDynamicMatrix operator-(const TDynamicMatrix& m)
   {
       if (sz != m.sz) throw out_of_range("Matrices have different sizes");
+      TMATRIX_SCOPED_OP(TOpKind::Sub, 0, 0);
+      TMATRIX_TRACE("matrix_sub");
 
       TDynamicMatrix result(sz);
       for (size_t i = 0; i < sz; ++i) {
@@ -318,26 +1063,27 @@ public:
 
   }
 
+  // произведение проверяет установленный кэш результатов (tcache.h)
   TDynamicMatrix operator*(const TDynamicMatrix& m)
   {
       if (sz != m.sz) throw out_of_range("Matrices have different sizes");
+      TProductCache<T>* cache = TProductCache<T>::installed();
+      if (!cache) return multiply_uncached(m);
 
-      TDynamicMatrix result(sz);
-      for (size_t i = 0; i < sz; i++) {
-          for (size_t j = 0; j < sz; ++j) {
-              T sum = T();
-              for (size_t k = 0; k < sz; k++) {
-                  sum += pMem[i][k] * m.pMem[k][j];
-              }
-              result.pMem[i][j] = sum;
-          }
-      }
+      auto key = TProductCache<T>::gemm_key(*this, m);
+      if (auto hit = cache->find_matrix(key, *this, m)) return *hit;
+      TDynamicMatrix result = multiply_uncached(m);
+      cache->insert(key, *this, m, result);
       return result;
   }
 
   // ввод/вывод
   friend istream& operator>>(istream& istr, TDynamicMatrix& v)
   {
+      TMATRIX_SCOPED_OP(TOpKind::IO, 0, 0);
+      TMATRIX_TRACE("matrix_read");
+      v.touch();
+      v.mark_all_dirty();
       for (size_t i = 0; i < v.sz; ++i) {
           istr >> v.pMem[i];
       }
@@ -346,12 +1092,124 @@ public:
 
   friend ostream& operator<<(ostream& ostr, const TDynamicMatrix& v)
   {
+      TMATRIX_SCOPED_OP(TOpKind::IO, 0, 0);
+      TMATRIX_TRACE("matrix_write");
       for (size_t i = 0; i < v.sz; ++i) {
           ostr << v.pMem[i] << '\n';
       }
       return ostr;
   }
 
+  // указатели на начала строк в rows[0..size()) для ядер с параллельной
+  // записью в строки. Неконстантный вариант один раз отмечает изменёнными
+  // все строки (версии, хеши, учёт строк), поэтому запись по указателям
+  // из разных потоков не обращается к служебным полям матрицы;
+  // operator[] внутри параллельных циклов для этого не годится
+  void row_pointers(T** rows)
+  {
+      this->touch();
+      mark_all_dirty();
+      for (size_t i = 0; i < sz; ++i)
+          rows[i] = &pMem[i][0];
+  }
+
+  TDynamicVector<T*> row_pointers()
+  {
+      TDynamicVector<T*> rows(sz);
+      row_pointers(&rows[0]);
+      return rows;
+  }
+
+  TDynamicVector<const T*> row_pointers() const
+  {
+      const TDynamicVector<T>* src = pMem;
+      TDynamicVector<const T*> rows(sz);
+      for (size_t i = 0; i < sz; ++i)
+          rows[i] = &src[i][0];
+      return rows;
+  }
+
+private:
+  TDynamicVector<T> multiply_uncached(const TDynamicVector<T>& v, TSumMode mode) const
+  {
+      TMATRIX_SCOPED_OP(TOpKind::Gemv, 2 * sz * sz, (sz * sz + 2 * sz) * sizeof(T));
+      TMATRIX_TRACE("gemv");
+
+      TDynamicVector<T> result(sz);
+      if (mode == TSumMode::Fast) {
+          gemv_detail::gemv(pMem, sz, &v[0], T(1), T(), &result[0]);
+          return result;
+      }
+      T* out = &result[0];
+#pragma omp parallel for if(sz >= 64 && mode != TSumMode::Parallel && mode != TSumMode::Reproducible)
+      for (long long i = 0; i < static_cast<long long>(sz); ++i) {
+          TMATRIX_MUTE_STATS();
+          out[i] = pMem[i].dot(v, mode);
+      }
+      return result;
+  }
+
+  TDynamicVector<T> left_multiply_uncached(const TDynamicVector<T>& x) const
+  {
+      TMATRIX_SCOPED_OP(TOpKind::Gemv, 2 * sz * sz, (sz * sz + 2 * sz) * sizeof(T));
+      TMATRIX_TRACE("gemv");
+
+      TDynamicVector<T> result(sz);
+      gemv_detail::gemv_transposed(pMem, sz, &x[0], T(1), T(), &result[0]);
+      return result;
+  }
+
+  TDynamicMatrix multiply_uncached(const TDynamicMatrix& m) const
+  {
+      TMATRIX_SCOPED_OP(TOpKind::Gemm, 2 * sz * sz * sz, 3 * sz * sz * sizeof(T));
+      TMATRIX_TRACE("gemm");
+
+      // блочное ядро полукольца (+, *): строки результата параллельно,
+      // для float и double внутренний цикл векторизуется
+      TDynamicMatrix result(sz);
+      semiring_multiply_into(*this, m, result, TPlusTimes<T>());
+      return result;
+  }
+
 };
 
+// Приближённое равенство (как numpy.allclose): |a - b| <= atol + rtol * |b|
+// для каждого элемента; размеры должны совпадать, NaN не равен ничему
+template<typename T>
+bool approx_equal(const TDynamicVector<T>& a, const TDynamicVector<T>& b, T rtol = T(1e-5), T atol = T(1e-8))
+{
+  if (a.size() != b.size()) return false;
+  if (a.size() == 0) return true;
+  return compare_detail::approx_equal(&a[0], &b[0], a.size(), rtol, atol);
+}
+
+template<typename T>
+bool approx_equal(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, T rtol = T(1e-5), T atol = T(1e-8))
+{
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); ++i)
+    if (!compare_detail::approx_equal(&a[i][0], &b[i][0], a.size(), rtol, atol)) return false;
+  return true;
+}
+
+// Векторы и матрицы как ключи unordered_map и unordered_set
+namespace std
+{
+  template<typename T>
+  struct hash<TDynamicVector<T>>
+  {
+    size_t operator()(const TDynamicVector<T>& v) const { return static_cast<size_t>(v.hash()); }
+  };
+
+  template<typename T>
+  struct hash<TDynamicMatrix<T>>
+  {
+    size_t operator()(const TDynamicMatrix<T>& m) const { return static_cast<size_t>(m.hash()); }
+  };
+}
+
+// кэш произведений и ядро произведения используют определения выше
+#include "tcache.h"
+#include "tsemiring.h"
+
 #endif
@@ -0,0 +1,122 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Аппаратные счётчики производительности через perf_event_open (Linux)
+
+#ifndef __TPerf_H__
+#define __TPerf_H__
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Показания аппаратных счётчиков
+struct TPerfSample
+{
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  uint64_t cacheMisses = 0;
+  uint64_t branchMisses = 0;
+
+  TPerfSample operator-(const TPerfSample& s) const
+  {
+    TPerfSample r;
+    r.cycles = cycles - s.cycles;
+    r.instructions = instructions - s.instructions;
+    r.cacheMisses = cacheMisses - s.cacheMisses;
+    r.branchMisses = branchMisses - s.branchMisses;
+    return r;
+  }
+};
+
+// Счётчики циклов, инструкций, промахов кэша и ветвлений вызывающего
+// потока и потоков, созданных им после открытия счётчиков (наследование
+// perf_event_open, только пользовательский режим); так учитываются
+// рабочие потоки OpenMP, если пул создан после открытия. Если ядро или
+// права не позволяют открыть счётчик (perf_event_paranoid, виртуальная
+// машина, не Linux), он читается как ноль, а available() возвращает false
+class TPerfCounters
+{
+  static constexpr int EVENT_COUNT = 4;
+  int fds[EVENT_COUNT];
+
+#if defined(__linux__)
+  static int open_event(uint64_t config)
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  static uint64_t read_event(int fd)
+  {
+    uint64_t value = 0;
+    if (fd >= 0 && ::read(fd, &value, sizeof(value)) != sizeof(value))
+      value = 0;
+    return value;
+  }
+#endif
+
+public:
+  TPerfCounters()
+  {
+#if defined(__linux__)
+    const uint64_t configs[EVENT_COUNT] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+    for (int e = 0; e < EVENT_COUNT; ++e)
+      fds[e] = open_event(configs[e]);
+#else
+    for (int e = 0; e < EVENT_COUNT; ++e)
+      fds[e] = -1;
+#endif
+  }
+
+  ~TPerfCounters()
+  {
+#if defined(__linux__)
+    for (int e = 0; e < EVENT_COUNT; ++e)
+      if (fds[e] >= 0) close(fds[e]);
+#endif
+  }
+
+  TPerfCounters(const TPerfCounters&) = delete;
+  TPerfCounters& operator=(const TPerfCounters&) = delete;
+
+  // открыт ли хотя бы счётчик циклов
+  bool available() const noexcept { return fds[0] >= 0; }
+
+  // накопленные с момента открытия значения
+  TPerfSample read() const
+  {
+    TPerfSample s;
+#if defined(__linux__)
+    s.cycles = read_event(fds[0]);
+    s.instructions = read_event(fds[1]);
+    s.cacheMisses = read_event(fds[2]);
+    s.branchMisses = read_event(fds[3]);
+#endif
+    return s;
+  }
+};
+
+// Счётчики текущего потока, открываются при первом обращении
+inline TPerfCounters& thread_perf_counters()
+{
+  thread_local TPerfCounters counters;
+  return counters;
+}
+
+#endif
@@ -0,0 +1,156 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Квантованная матрица int8 с масштабами по строкам или столбцам
+
+#ifndef __TQuantized_H__
+#define __TQuantized_H__
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "tmatrix.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Ось, вдоль которой берётся общий масштаб
+enum class TQuantAxis { Rows, Columns };
+
+namespace quant_detail
+{
+  // Скалярное произведение int8 с накоплением в int32.
+  // AVX2: |a| (u8) * sign(b, a) (s8) через maddubs, затем madd с единицами;
+  // с AVX-VNNI или AVX512-VNNI используется dpbusd. Значения ограничены
+  // [-127, 127], поэтому пары произведений в maddubs не насыщаются.
+  // Векторная ветвь собирается с опцией CMake TMATRIX_NATIVE (-march=native),
+  // VNNI - только если он есть у процессора машины сборки
+  inline int32_t dot_i8(const int8_t* a, const int8_t* b, size_t n)
+  {
+    size_t k = 0;
+    int32_t sum = 0;
+#if defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+#if !(defined(__AVX512VNNI__) && defined(__AVX512VL__)) && !defined(__AVXVNNI__)
+    const __m256i ones = _mm256_set1_epi16(1);
+#endif
+    for (; k + 32 <= n; k += 32) {
+      __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + k));
+      __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + k));
+      __m256i ua = _mm256_sign_epi8(va, va);
+      __m256i sb = _mm256_sign_epi8(vb, va);
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+      acc = _mm256_dpbusd_epi32(acc, ua, sb);
+#elif defined(__AVXVNNI__)
+      acc = _mm256_dpbusd_avx_epi32(acc, ua, sb);
+#else
+      acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_maddubs_epi16(ua, sb), ones));
+#endif
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum = _mm_cvtsi128_si32(s);
+#endif
+    for (; k < n; ++k)
+      sum += static_cast<int32_t>(a[k]) * static_cast<int32_t>(b[k]);
+    return sum;
+  }
+}
+
+// Симметрично квантованная матрица: x ~ scale * q, q в [-127, 127].
+// При axis == Rows масштаб общий для строки, при axis == Columns - для
+// столбца; в последнем случае данные хранятся по столбцам, чтобы
+// произведение читало оба операнда подряд
+class TQuantizedMatrix
+{
+protected:
+  size_t sz;
+  TQuantAxis axis;
+  TDynamicVector<int8_t> data;
+  TDynamicVector<float> scales;
+
+  // номер строки хранения и позиция в ней для элемента (i, j)
+  size_t offset(size_t i, size_t j) const
+  {
+    return axis == TQuantAxis::Rows ? i * sz + j : j * sz + i;
+  }
+
+public:
+  TQuantizedMatrix(const TDynamicMatrix<float>& m, TQuantAxis ax = TQuantAxis::Rows)
+    : sz(m.size()), axis(ax), data(m.size() * m.size()), scales(m.size())
+  {
+    for (size_t l = 0; l < sz; ++l) {
+      float maxAbs = 0.0f;
+      for (size_t t = 0; t < sz; ++t) {
+        float x = axis == TQuantAxis::Rows ? m[l][t] : m[t][l];
+        maxAbs = std::max(maxAbs, std::fabs(x));
+      }
+      float scale = maxAbs > 0.0f ? maxAbs / 127.0f : 1.0f;
+      scales[l] = scale;
+      for (size_t t = 0; t < sz; ++t) {
+        float x = axis == TQuantAxis::Rows ? m[l][t] : m[t][l];
+        float q = std::nearbyint(x / scale);
+        data[l * sz + t] = static_cast<int8_t>(std::max(-127.0f, std::min(127.0f, q)));
+      }
+    }
+  }
+
+  size_t size() const noexcept { return sz; }
+  TQuantAxis quant_axis() const noexcept { return axis; }
+
+  int8_t value(size_t i, size_t j) const { return data[offset(i, j)]; }
+  float scale(size_t l) const { return scales[l]; }
+
+  // восстановленное значение элемента (i, j)
+  float get(size_t i, size_t j) const
+  {
+    return scales[axis == TQuantAxis::Rows ? i : j] * data[offset(i, j)];
+  }
+
+  TDynamicMatrix<float> dequantize() const
+  {
+    TDynamicMatrix<float> m(sz);
+    for (size_t i = 0; i < sz; ++i)
+      for (size_t j = 0; j < sz; ++j)
+        m[i][j] = get(i, j);
+    return m;
+  }
+
+  // C = A * B: A квантована по строкам, B - по столбцам;
+  // c[i][j] = sa[i] * sb[j] * sum_k qa[i][k] * qb[k][j]
+  friend TDynamicMatrix<float> quantized_multiply(const TQuantizedMatrix& a, const TQuantizedMatrix& b)
+  {
+    if (a.sz != b.sz) throw out_of_range("Matrices have different sizes");
+    if (a.axis != TQuantAxis::Rows || b.axis != TQuantAxis::Columns)
+      throw invalid_argument("Left operand must be quantized by rows, right by columns");
+    size_t n = a.sz;
+    TDynamicMatrix<float> c(n);
+    const int8_t* pa = &a.data[0];
+    const int8_t* pb = &b.data[0];
+    TDynamicVector<float*> rows = c.row_pointers();
+    float* const* cr = &rows[0];
+#pragma omp parallel for if(n >= 128)
+    for (long long ii = 0; ii < static_cast<long long>(n); ++ii) {
+      size_t i = static_cast<size_t>(ii);
+      for (size_t j = 0; j < n; ++j)
+        cr[i][j] = a.scales[i] * b.scales[j] * quant_detail::dot_i8(pa + i * n, pb + j * n, n);
+    }
+    return c;
+  }
+};
+
+inline TQuantizedMatrix quantize(const TDynamicMatrix<float>& m, TQuantAxis axis = TQuantAxis::Rows)
+{
+  return TQuantizedMatrix(m, axis);
+}
+
+inline TDynamicMatrix<float> dequantize(const TQuantizedMatrix& q)
+{
+  return q.dequantize();
+}
+
+#endif
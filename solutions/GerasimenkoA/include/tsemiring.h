@@ -0,0 +1,244 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Произведение матриц над произвольным полукольцом
+
+#ifndef __TSemiring_H__
+#define __TSemiring_H__
+
+#include <limits>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "tmatrix.h"
+
+// Полукольцо задаёт нейтральный элемент сложения zero(),
+// "сложение" add и "умножение" mul
+
+// Обычная арифметика (+, *)
+template<typename T>
+struct TPlusTimes
+{
+  T zero() const { return T(); }
+  T add(T a, T b) const { return a + b; }
+  T mul(T a, T b) const { return a * b; }
+};
+
+// Арифметика по модулю mod для целых T (mod <= 2^32)
+template<typename T>
+struct TModPlusTimes
+{
+  unsigned long long mod;
+  TModPlusTimes(T m) : mod(static_cast<unsigned long long>(m)) {}
+  T zero() const { return T(); }
+  T add(T a, T b) const
+  {
+    return static_cast<T>((static_cast<unsigned long long>(a) + static_cast<unsigned long long>(b)) % mod);
+  }
+  T mul(T a, T b) const
+  {
+    return static_cast<T>(static_cast<unsigned long long>(a) * static_cast<unsigned long long>(b) % mod);
+  }
+};
+
+// Бесконечность для тропических полуколец: для целых берётся половина
+// максимума, чтобы сумма двух "бесконечностей" не переполнялась
+template<typename T>
+T semiring_infinity()
+{
+  return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+    : std::numeric_limits<T>::max() / 2;
+}
+
+// Тропическое (min, +): кратчайшие пути
+template<typename T>
+struct TMinPlus
+{
+  T zero() const { return semiring_infinity<T>(); }
+  T add(T a, T b) const { return b < a ? b : a; }
+  T mul(T a, T b) const { return a + b; }
+};
+
+// Тропическое (max, +): алгоритм Витерби
+template<typename T>
+struct TMaxPlus
+{
+  T zero() const { return -semiring_infinity<T>(); }
+  T add(T a, T b) const { return a < b ? b : a; }
+  T mul(T a, T b) const { return a + b; }
+};
+
+// Булево (or, and): достижимость
+struct TOrAnd
+{
+  bool zero() const { return false; }
+  bool add(bool a, bool b) const { return a || b; }
+  bool mul(bool a, bool b) const { return a && b; }
+};
+
+namespace semiring_detail
+{
+  constexpr size_t ROW_BLOCK = 32;
+  constexpr size_t DEPTH_BLOCK = 64;
+
+  // Буфер вызывающего потока для упаковки панелей и массивов указателей
+  // на строки: растёт до наибольшего запрошенного размера и
+  // переиспользуется, так что повторные произведения одного размера
+  // не выделяют память
+  template<typename T>
+  T* workspace(size_t count)
+  {
+    thread_local std::unique_ptr<T[]> buf;
+    thread_local size_t capacity = 0;
+    if (count > capacity) {
+      TMATRIX_COUNT_ALLOC(count * sizeof(T));
+      buf.reset(new T[count]);
+      capacity = count;
+    }
+    return buf.get();
+  }
+
+  // bp[(k - k0) * n + j] = b[j][k] для k из [k0, k1): строки панели -
+  // столбцы b, упакованные подряд
+  template<typename T>
+  void pack_transposed_panel(const TDynamicMatrix<T>& b, size_t k0, size_t k1, T* bp)
+  {
+    size_t n = b.size();
+#pragma omp parallel for if(n >= 128)
+    for (long long j = 0; j < static_cast<long long>(n); ++j) {
+      const T* bj = &b[j][0];
+      for (size_t k = k0; k < k1; ++k)
+        bp[(k - k0) * n + j] = bj[k];
+    }
+  }
+
+  // ci[j] = add(ci[j], mul(aik, bk[j])) для всех j
+  template<typename T, typename S>
+  struct TRowUpdate
+  {
+    static void run(const S& s, T* ci, T aik, const T* bk, size_t n)
+    {
+      if (aik == s.zero()) return;
+      for (size_t j = 0; j < n; ++j)
+        ci[j] = s.add(ci[j], s.mul(aik, bk[j]));
+    }
+  };
+
+  // (min, +) для int и float: без ветвлений во внутреннем цикле,
+  // что позволяет компилятору векторизовать его
+  template<typename T>
+  struct TMinPlusRowUpdate
+  {
+    static void run(const TMinPlus<T>&, T* ci, T aik, const T* bk, size_t n)
+    {
+      if (aik >= semiring_infinity<T>()) return;
+      for (size_t j = 0; j < n; ++j) {
+        T x = aik + bk[j];
+        ci[j] = x < ci[j] ? x : ci[j];
+      }
+    }
+  };
+
+  template<>
+  struct TRowUpdate<int, TMinPlus<int>> : TMinPlusRowUpdate<int> {};
+  template<>
+  struct TRowUpdate<float, TMinPlus<float>> : TMinPlusRowUpdate<float> {};
+
+  template<typename T>
+  struct TPlusTimesRowUpdate
+  {
+    static void run(const TPlusTimes<T>&, T* ci, T aik, const T* bk, size_t n)
+    {
+      for (size_t j = 0; j < n; ++j)
+        ci[j] += aik * bk[j];
+    }
+  };
+
+  template<>
+  struct TRowUpdate<float, TPlusTimes<float>> : TPlusTimesRowUpdate<float> {};
+  template<>
+  struct TRowUpdate<double, TPlusTimes<double>> : TPlusTimesRowUpdate<double> {};
+}
+
+// c = op(a) (x) op(b) над полукольцом s в заранее выделенную матрицу c,
+// где op(x) = x или x^T согласно флагам ta и tb.
+// Строки разбиты на блоки по ROW_BLOCK, глубина k - по DEPTH_BLOCK,
+// так что блок строк op(b) переиспользуется из кэша; блоки строк
+// обрабатываются параллельно (OpenMP), c не должна совпадать с a или b
+// (иначе invalid_argument).
+// Транспонированный b не копируется целиком: на каждый блок глубины
+// упаковывается панель DEPTH_BLOCK x n из его столбцов в буфер потока
+template<typename S, typename T>
+void semiring_multiply_into(const TDynamicMatrix<T>& a, TTrans ta, const TDynamicMatrix<T>& b, TTrans tb,
+  TDynamicMatrix<T>& c, const S& s = S())
+{
+  using namespace semiring_detail;
+  size_t n = a.size();
+  if (b.size() != n || c.size() != n)
+    throw out_of_range("Matrices have different sizes");
+  if (&c == &a || &c == &b)
+    throw invalid_argument("Result matrix must differ from the operands");
+  TMATRIX_TRACE("semiring_gemm");
+  long long blocks = static_cast<long long>((n + ROW_BLOCK - 1) / ROW_BLOCK);
+  bool transA = ta == TTrans::Yes;
+  T** cr = workspace<T*>(n);
+  c.row_pointers(cr);
+
+  if (tb == TTrans::No) {
+#pragma omp parallel for schedule(dynamic) if(n >= 128)
+    for (long long blk = 0; blk < blocks; ++blk) {
+      size_t i0 = static_cast<size_t>(blk) * ROW_BLOCK;
+      size_t i1 = std::min(n, i0 + ROW_BLOCK);
+      for (size_t i = i0; i < i1; ++i)
+        std::fill(cr[i], cr[i] + n, s.zero());
+      for (size_t k0 = 0; k0 < n; k0 += DEPTH_BLOCK) {
+        size_t k1 = std::min(n, k0 + DEPTH_BLOCK);
+        for (size_t i = i0; i < i1; ++i) {
+          T* ci = cr[i];
+          for (size_t k = k0; k < k1; ++k)
+            TRowUpdate<T, S>::run(s, ci, transA ? a[k][i] : a[i][k], &b[k][0], n);
+        }
+      }
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < n; ++i)
+    std::fill(cr[i], cr[i] + n, s.zero());
+  T* bp = workspace<T>(std::min(n, DEPTH_BLOCK) * n);
+  for (size_t k0 = 0; k0 < n; k0 += DEPTH_BLOCK) {
+    size_t k1 = std::min(n, k0 + DEPTH_BLOCK);
+    pack_transposed_panel(b, k0, k1, bp);
+#pragma omp parallel for schedule(dynamic) if(n >= 128)
+    for (long long blk = 0; blk < blocks; ++blk) {
+      size_t i0 = static_cast<size_t>(blk) * ROW_BLOCK;
+      size_t i1 = std::min(n, i0 + ROW_BLOCK);
+      for (size_t i = i0; i < i1; ++i) {
+        T* ci = cr[i];
+        for (size_t k = k0; k < k1; ++k)
+          TRowUpdate<T, S>::run(s, ci, transA ? a[k][i] : a[i][k], bp + (k - k0) * n, n);
+      }
+    }
+  }
+}
+
+template<typename S, typename T>
+void semiring_multiply_into(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b,
+  TDynamicMatrix<T>& c, const S& s = S())
+{
+  semiring_multiply_into(a, TTrans::No, b, TTrans::No, c, s);
+}
+
+// c = a (x) b над полукольцом S с выделением результата
+template<typename S, typename T>
+TDynamicMatrix<T> semiring_multiply(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b,
+  const S& s = S())
+{
+  TDynamicMatrix<T> c(a.size());
+  semiring_multiply_into(a, b, c, s);
+  return c;
+}
+
+#endif
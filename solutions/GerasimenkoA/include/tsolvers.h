@@ -0,0 +1,378 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Итерационные методы Крылова для систем A * x = b
+
+#ifndef __TSolvers_H__
+#define __TSolvers_H__
+
+#include <chrono>
+#include <vector>
+#include "tlinalg.h"
+
+// Оператор задаётся любым вызываемым объектом op(x, y), вычисляющим y = A * x;
+// предобусловливатель - вызываемым объектом m(r, z), вычисляющим z = M^-1 * r
+
+// Параметры итерационного решателя
+struct TSolverParams
+{
+  double tol = 1e-8;      // порог относительной невязки ||r|| / ||b||
+  size_t maxIters = 1000;
+  size_t restart = 30;    // длина цикла GMRES(m)
+};
+
+// Результат: история относительной невязки и время каждой итерации
+template<typename T>
+struct TSolverResult
+{
+  bool converged = false;
+  size_t iterations = 0;
+  std::vector<T> residuals;
+  std::vector<double> iterationSeconds;
+};
+
+// Оператор для плотной матрицы: библиотечный gemv в существующий y,
+// блоки строк параллельно, без выделения памяти на итерации
+template<typename T>
+auto make_operator(const TDynamicMatrix<T>& a)
+{
+  return [&a](const TDynamicVector<T>& x, TDynamicVector<T>& y) {
+    gemv(T(1), a, TTrans::No, x, T(), y);
+  };
+}
+
+// Тождественный предобусловливатель
+template<typename T>
+struct TIdentityPreconditioner
+{
+  void operator()(const TDynamicVector<T>& r, TDynamicVector<T>& z) const
+  {
+    for (size_t i = 0; i < r.size(); ++i)
+      z[i] = r[i];
+  }
+};
+
+// Предобусловливатель Якоби: M = diag(A)
+template<typename T>
+class TJacobiPreconditioner
+{
+  TDynamicVector<T> invDiag;
+public:
+  TJacobiPreconditioner(const TDynamicMatrix<T>& a) : invDiag(a.size())
+  {
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (a[i][i] == T()) throw invalid_argument("Zero diagonal element");
+      invDiag[i] = T(1) / a[i][i];
+    }
+  }
+
+  void operator()(const TDynamicVector<T>& r, TDynamicVector<T>& z) const
+  {
+    for (size_t i = 0; i < r.size(); ++i)
+      z[i] = invDiag[i] * r[i];
+  }
+};
+
+// Неполное LU-разложение без заполнения: L и U сохраняют
+// портрет ненулевых элементов A, L - с единичной диагональю
+template<typename T>
+class TIlu0Preconditioner
+{
+  TDynamicMatrix<T> lu;
+public:
+  TIlu0Preconditioner(const TDynamicMatrix<T>& a) : lu(a)
+  {
+    TMATRIX_TRACE("ilu0");
+    size_t n = lu.size();
+    for (size_t i = 1; i < n; ++i) {
+      for (size_t k = 0; k < i; ++k) {
+        if (lu[i][k] == T() || a[i][k] == T()) continue;
+        if (lu[k][k] == T()) throw invalid_argument("Zero pivot in ILU(0)");
+        lu[i][k] /= lu[k][k];
+        for (size_t j = k + 1; j < n; ++j)
+          if (a[i][j] != T())
+            lu[i][j] -= lu[i][k] * lu[k][j];
+      }
+    }
+  }
+
+  void operator()(const TDynamicVector<T>& r, TDynamicVector<T>& z) const
+  {
+    size_t n = lu.size();
+    for (size_t i = 0; i < n; ++i) {
+      T s = r[i];
+      for (size_t j = 0; j < i; ++j)
+        s -= lu[i][j] * z[j];
+      z[i] = s;
+    }
+    for (size_t i = n; i-- > 0;) {
+      T s = z[i];
+      for (size_t j = i + 1; j < n; ++j)
+        s -= lu[i][j] * z[j];
+      z[i] = s / lu[i][i];
+    }
+  }
+};
+
+namespace solvers_detail
+{
+  using clock = std::chrono::steady_clock;
+
+  inline double seconds_since(clock::time_point t)
+  {
+    return std::chrono::duration<double>(clock::now() - t).count();
+  }
+
+  template<typename T>
+  T norm(const TDynamicVector<T>& x)
+  {
+    return std::sqrt(dot_product(x, x));
+  }
+
+  template<typename T>
+  void check_sizes(const TDynamicVector<T>& b, const TDynamicVector<T>& x)
+  {
+    if (b.size() != x.size()) throw out_of_range("Right-hand side and solution sizes mismatch");
+  }
+}
+
+// Метод сопряжённых градиентов (A и M симметричны и положительно
+// определены). Если p^T * A * p или r^T * M^-1 * r не положительно
+// (A или M не положительно определена, NaN), метод останавливается
+// с converged == false, x остаётся последним приближением
+template<typename T, typename Op, typename Prec = TIdentityPreconditioner<T>>
+TSolverResult<T> cg(const Op& op, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+  const TSolverParams& params = TSolverParams(), const Prec& prec = Prec())
+{
+  using namespace solvers_detail;
+  check_sizes(b, x);
+  TMATRIX_TRACE("cg");
+  size_t n = b.size();
+  TSolverResult<T> res;
+  TDynamicVector<T> r(n), z(n), p(n), q(n);
+
+  op(x, q);
+  for (size_t i = 0; i < n; ++i)
+    r[i] = b[i] - q[i];
+  T bnorm = norm(b);
+  if (bnorm == T()) bnorm = T(1);
+  T rnorm2 = dot_product(r, r);
+  if (std::sqrt(rnorm2) / bnorm <= params.tol) {
+    res.converged = true;
+    return res;
+  }
+  prec(r, z);
+  T rz = dot_product(r, z);
+  if (!(rz > T())) return res;
+  for (size_t i = 0; i < n; ++i)
+    p[i] = z[i];
+
+  while (res.iterations < params.maxIters) {
+    auto start = clock::now();
+    op(p, q);
+    T pq = dot_product(p, q);
+    if (!(pq > T())) break;
+    T alpha = rz / pq;
+    // x += alpha * p, r -= alpha * q и ||r||^2 за один проход
+    rnorm2 = T();
+    for (size_t i = 0; i < n; ++i) {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+      rnorm2 += r[i] * r[i];
+    }
+    ++res.iterations;
+    T rel = std::sqrt(rnorm2) / bnorm;
+    if (rel <= params.tol) {
+      res.residuals.push_back(rel);
+      res.iterationSeconds.push_back(seconds_since(start));
+      res.converged = true;
+      break;
+    }
+    prec(r, z);
+    T rzNew = dot_product(r, z);
+    if (!(rzNew > T())) {
+      res.residuals.push_back(rel);
+      res.iterationSeconds.push_back(seconds_since(start));
+      break;
+    }
+    T beta = rzNew / rz;
+    rz = rzNew;
+    for (size_t i = 0; i < n; ++i)
+      p[i] = z[i] + beta * p[i];
+    res.residuals.push_back(rel);
+    res.iterationSeconds.push_back(seconds_since(start));
+  }
+  return res;
+}
+
+// Стабилизированный метод бисопряжённых градиентов (правое предобусловливание)
+template<typename T, typename Op, typename Prec = TIdentityPreconditioner<T>>
+TSolverResult<T> bicgstab(const Op& op, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+  const TSolverParams& params = TSolverParams(), const Prec& prec = Prec())
+{
+  using namespace solvers_detail;
+  check_sizes(b, x);
+  TMATRIX_TRACE("bicgstab");
+  size_t n = b.size();
+  TSolverResult<T> res;
+  TDynamicVector<T> r(n), r0(n), p(n), v(n), s(n), t(n), ph(n), sh(n);
+
+  op(x, v);
+  for (size_t i = 0; i < n; ++i) {
+    r[i] = b[i] - v[i];
+    r0[i] = r[i];
+    v[i] = T();
+  }
+  T bnorm = norm(b);
+  if (bnorm == T()) bnorm = T(1);
+  if (norm(r) / bnorm <= params.tol) {
+    res.converged = true;
+    return res;
+  }
+  T rho = T(1), alpha = T(1), omega = T(1);
+
+  while (res.iterations < params.maxIters) {
+    auto start = clock::now();
+    T rhoNew = dot_product(r0, r);
+    if (rhoNew == T()) break;
+    T beta = (rhoNew / rho) * (alpha / omega);
+    rho = rhoNew;
+    for (size_t i = 0; i < n; ++i)
+      p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    prec(p, ph);
+    op(ph, v);
+    alpha = rho / dot_product(r0, v);
+    T snorm2 = T();
+    for (size_t i = 0; i < n; ++i) {
+      s[i] = r[i] - alpha * v[i];
+      snorm2 += s[i] * s[i];
+    }
+    ++res.iterations;
+    if (std::sqrt(snorm2) / bnorm <= params.tol) {
+      axpy(alpha, ph, x);
+      res.residuals.push_back(std::sqrt(snorm2) / bnorm);
+      res.iterationSeconds.push_back(seconds_since(start));
+      res.converged = true;
+      break;
+    }
+    prec(s, sh);
+    op(sh, t);
+    T tt = T(), ts = T();
+    for (size_t i = 0; i < n; ++i) {
+      tt += t[i] * t[i];
+      ts += t[i] * s[i];
+    }
+    omega = ts / tt;
+    // обновление x и r вместе с ||r||^2 за один проход
+    T rnorm2 = T();
+    for (size_t i = 0; i < n; ++i) {
+      x[i] += alpha * ph[i] + omega * sh[i];
+      r[i] = s[i] - omega * t[i];
+      rnorm2 += r[i] * r[i];
+    }
+    T rel = std::sqrt(rnorm2) / bnorm;
+    res.residuals.push_back(rel);
+    res.iterationSeconds.push_back(seconds_since(start));
+    if (rel <= params.tol) {
+      res.converged = true;
+      break;
+    }
+    if (omega == T()) break;
+  }
+  return res;
+}
+
+// Обобщённый метод минимальных невязок с перезапуском GMRES(m),
+// правое предобусловливание, вращения Гивенса
+template<typename T, typename Op, typename Prec = TIdentityPreconditioner<T>>
+TSolverResult<T> gmres(const Op& op, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+  const TSolverParams& params = TSolverParams(), const Prec& prec = Prec())
+{
+  using namespace solvers_detail;
+  check_sizes(b, x);
+  TMATRIX_TRACE("gmres");
+  size_t n = b.size();
+  size_t m = std::max<size_t>(1, std::min(params.restart, n));
+  TSolverResult<T> res;
+  TColumnBlock<T> basis = make_column_block<T>(n, m + 1);
+  TDynamicMatrix<T> h(m + 1);
+  TDynamicVector<T> cs(m), sn(m), g(m + 1), y(m), w(n), z(n);
+
+  T bnorm = norm(b);
+  if (bnorm == T()) bnorm = T(1);
+
+  while (res.iterations < params.maxIters) {
+    op(x, w);
+    for (size_t i = 0; i < n; ++i)
+      basis[0][i] = b[i] - w[i];
+    T beta = norm(basis[0]);
+    if (beta / bnorm <= params.tol) {
+      res.converged = true;
+      break;
+    }
+    for (size_t i = 0; i < n; ++i)
+      basis[0][i] /= beta;
+    for (size_t i = 0; i <= m; ++i)
+      g[i] = T();
+    g[0] = beta;
+
+    size_t k = 0;
+    while (k < m && res.iterations < params.maxIters) {
+      auto start = clock::now();
+      prec(basis[k], z);
+      op(z, w);
+      for (size_t j = 0; j <= k; ++j) {
+        h[j][k] = dot_product(w, basis[j]);
+        axpy(-h[j][k], basis[j], w);
+      }
+      h[k + 1][k] = norm(w);
+      if (h[k + 1][k] != T())
+        for (size_t i = 0; i < n; ++i)
+          basis[k + 1][i] = w[i] / h[k + 1][k];
+
+      for (size_t j = 0; j < k; ++j) {
+        T tmp = cs[j] * h[j][k] + sn[j] * h[j + 1][k];
+        h[j + 1][k] = -sn[j] * h[j][k] + cs[j] * h[j + 1][k];
+        h[j][k] = tmp;
+      }
+      T d = std::sqrt(h[k][k] * h[k][k] + h[k + 1][k] * h[k + 1][k]);
+      cs[k] = d != T() ? h[k][k] / d : T(1);
+      sn[k] = d != T() ? h[k + 1][k] / d : T();
+      h[k][k] = d;
+      h[k + 1][k] = T();
+      g[k + 1] = -sn[k] * g[k];
+      g[k] = cs[k] * g[k];
+
+      ++k;
+      ++res.iterations;
+      T rel = std::abs(g[k]) / bnorm;
+      res.residuals.push_back(rel);
+      res.iterationSeconds.push_back(seconds_since(start));
+      if (rel <= params.tol)
+        break;
+    }
+
+    // y = H^-1 * g, x += M^-1 * V * y
+    for (size_t i = k; i-- > 0;) {
+      T s = g[i];
+      for (size_t j = i + 1; j < k; ++j)
+        s -= h[i][j] * y[j];
+      y[i] = s / h[i][i];
+    }
+    for (size_t i = 0; i < n; ++i)
+      w[i] = T();
+    for (size_t j = 0; j < k; ++j)
+      axpy(y[j], basis[j], w);
+    prec(w, z);
+    axpy(T(1), z, x);
+
+    if (!res.residuals.empty() && res.residuals.back() <= params.tol) {
+      res.converged = true;
+      break;
+    }
+  }
+  return res;
+}
+
+#endif
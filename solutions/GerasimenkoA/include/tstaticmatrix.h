@@ -0,0 +1,268 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Вектор и матрица фиксированного размера на стеке
+
+#ifndef __TStaticMatrix_H__
+#define __TStaticMatrix_H__
+
+#include <utility>
+#include <stdexcept>
+#include <initializer_list>
+#include "tmatrix.h"
+
+namespace static_detail
+{
+  // f(0), f(1), ..., f(N - 1), развёрнутые на этапе компиляции
+  template<typename F, size_t... I>
+  constexpr void unroll(F&& f, std::index_sequence<I...>)
+  {
+    (f(I), ...);
+  }
+
+  template<size_t N, typename F>
+  constexpr void unroll(F&& f)
+  {
+    unroll(std::forward<F>(f), std::make_index_sequence<N>());
+  }
+}
+
+// Статический вектор - 
+// шаблонный вектор длины N на стеке, пригоден в constexpr-выражениях
+template<typename T, size_t N>
+class TStaticVector
+{
+  static_assert(N > 0, "Vector size should be greater than zero");
+protected:
+  T pMem[N];
+
+public:
+  constexpr TStaticVector() : pMem{} {}
+
+  constexpr TStaticVector(std::initializer_list<T> il) : pMem{}
+  {
+    size_t i = 0;
+    for (const T& x : il) {
+      if (i == N) break;
+      pMem[i++] = x;
+    }
+  }
+
+  explicit TStaticVector(const TDynamicVector<T>& v) : pMem{}
+  {
+    if (v.size() != N) throw out_of_range("Vector sizes are incompatible");
+    for (size_t i = 0; i < N; ++i)
+      pMem[i] = v[i];
+  }
+
+  TDynamicVector<T> to_dynamic() const
+  {
+    TDynamicVector<T> v(N);
+    for (size_t i = 0; i < N; ++i)
+      v[i] = pMem[i];
+    return v;
+  }
+
+  static constexpr size_t size() noexcept { return N; }
+
+  // индексация
+  constexpr T& operator[](size_t ind) { return pMem[ind]; }
+  constexpr const T& operator[](size_t ind) const { return pMem[ind]; }
+
+  // индексация с контролем
+  constexpr T& at(size_t ind)
+  {
+    if (ind >= N) throw out_of_range("Index out of range");
+    return pMem[ind];
+  }
+  constexpr const T& at(size_t ind) const
+  {
+    if (ind >= N) throw out_of_range("Index out of range");
+    return pMem[ind];
+  }
+
+  // сравнение
+  constexpr bool operator==(const TStaticVector& v) const noexcept
+  {
+    bool eq = true;
+    static_detail::unroll<N>([&](size_t i) { eq = eq && pMem[i] == v.pMem[i]; });
+    return eq;
+  }
+  constexpr bool operator!=(const TStaticVector& v) const noexcept
+  {
+    return !(*this == v);
+  }
+
+  // скалярные операции
+  constexpr TStaticVector operator+(T val) const
+  {
+    TStaticVector r;
+    static_detail::unroll<N>([&](size_t i) { r.pMem[i] = pMem[i] + val; });
+    return r;
+  }
+  constexpr TStaticVector operator-(T val) const
+  {
+    TStaticVector r;
+    static_detail::unroll<N>([&](size_t i) { r.pMem[i] = pMem[i] - val; });
+    return r;
+  }
+  constexpr TStaticVector operator*(T val) const
+  {
+    TStaticVector r;
+    static_detail::unroll<N>([&](size_t i) { r.pMem[i] = pMem[i] * val; });
+    return r;
+  }
+
+  // векторные операции
+  constexpr TStaticVector operator+(const TStaticVector& v) const
+  {
+    TStaticVector r;
+    static_detail::unroll<N>([&](size_t i) { r.pMem[i] = pMem[i] + v.pMem[i]; });
+    return r;
+  }
+  constexpr TStaticVector operator-(const TStaticVector& v) const
+  {
+    TStaticVector r;
+    static_detail::unroll<N>([&](size_t i) { r.pMem[i] = pMem[i] - v.pMem[i]; });
+    return r;
+  }
+  constexpr T operator*(const TStaticVector& v) const
+  {
+    T s = T();
+    static_detail::unroll<N>([&](size_t i) { s += pMem[i] * v.pMem[i]; });
+    return s;
+  }
+
+  // ввод/вывод
+  friend istream& operator>>(istream& istr, TStaticVector& v)
+  {
+    for (size_t i = 0; i < N; ++i)
+      istr >> v.pMem[i];
+    return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TStaticVector& v)
+  {
+    ostr << v.pMem[0];
+    for (size_t i = 1; i < N; ++i)
+      ostr << " " << v.pMem[i];
+    return ostr;
+  }
+};
+
+
+// Статическая матрица - 
+// шаблонная квадратная матрица N x N на стеке
+template<typename T, size_t N>
+class TStaticMatrix : private TStaticVector<TStaticVector<T, N>, N>
+{
+  using TStaticVector<TStaticVector<T, N>, N>::pMem;
+public:
+  constexpr TStaticMatrix() : TStaticVector<TStaticVector<T, N>, N>() {}
+
+  constexpr TStaticMatrix(std::initializer_list<std::initializer_list<T>> il)
+    : TStaticVector<TStaticVector<T, N>, N>()
+  {
+    size_t i = 0;
+    for (const auto& row : il) {
+      if (i == N) break;
+      pMem[i++] = TStaticVector<T, N>(row);
+    }
+  }
+
+  explicit TStaticMatrix(const TDynamicMatrix<T>& m) : TStaticVector<TStaticVector<T, N>, N>()
+  {
+    if (m.size() != N) throw out_of_range("Matrix sizes are incompatible");
+    for (size_t i = 0; i < N; ++i)
+      for (size_t j = 0; j < N; ++j)
+        pMem[i][j] = m[i][j];
+  }
+
+  TDynamicMatrix<T> to_dynamic() const
+  {
+    TDynamicMatrix<T> m(N);
+    for (size_t i = 0; i < N; ++i)
+      for (size_t j = 0; j < N; ++j)
+        m[i][j] = pMem[i][j];
+    return m;
+  }
+
+  static constexpr TStaticMatrix identity()
+  {
+    TStaticMatrix m;
+    static_detail::unroll<N>([&](size_t i) { m.pMem[i][i] = T(1); });
+    return m;
+  }
+
+  using TStaticVector<TStaticVector<T, N>, N>::size;
+  using TStaticVector<TStaticVector<T, N>, N>::operator[];
+  using TStaticVector<TStaticVector<T, N>, N>::at;
+
+  // сравнение
+  constexpr bool operator==(const TStaticMatrix& m) const noexcept
+  {
+    bool eq = true;
+    static_detail::unroll<N>([&](size_t i) { eq = eq && pMem[i] == m.pMem[i]; });
+    return eq;
+  }
+  constexpr bool operator!=(const TStaticMatrix& m) const noexcept
+  {
+    return !(*this == m);
+  }
+
+  // матрично-скалярные операции
+  constexpr TStaticMatrix operator*(const T& val) const
+  {
+    TStaticMatrix r;
+    static_detail::unroll<N>([&](size_t i) { r.pMem[i] = pMem[i] * val; });
+    return r;
+  }
+
+  // матрично-векторные операции
+  constexpr TStaticVector<T, N> operator*(const TStaticVector<T, N>& v) const
+  {
+    TStaticVector<T, N> r;
+    static_detail::unroll<N>([&](size_t i) { r[i] = pMem[i] * v; });
+    return r;
+  }
+
+  // матрично-матричные операции
+  constexpr TStaticMatrix operator+(const TStaticMatrix& m) const
+  {
+    TStaticMatrix r;
+    static_detail::unroll<N>([&](size_t i) { r.pMem[i] = pMem[i] + m.pMem[i]; });
+    return r;
+  }
+  constexpr TStaticMatrix operator-(const TStaticMatrix& m) const
+  {
+    TStaticMatrix r;
+    static_detail::unroll<N>([&](size_t i) { r.pMem[i] = pMem[i] - m.pMem[i]; });
+    return r;
+  }
+  constexpr TStaticMatrix operator*(const TStaticMatrix& m) const
+  {
+    TStaticMatrix r;
+    static_detail::unroll<N>([&](size_t i) {
+      static_detail::unroll<N>([&](size_t k) {
+        r.pMem[i] = r.pMem[i] + m.pMem[k] * pMem[i][k];
+      });
+    });
+    return r;
+  }
+
+  // ввод/вывод
+  friend istream& operator>>(istream& istr, TStaticMatrix& m)
+  {
+    for (size_t i = 0; i < N; ++i)
+      istr >> m.pMem[i];
+    return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TStaticMatrix& m)
+  {
+    for (size_t i = 0; i < N; ++i)
+      ostr << m.pMem[i] << '\n';
+    return ostr;
+  }
+};
+
+#endif
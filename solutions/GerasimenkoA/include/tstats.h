@@ -0,0 +1,235 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Счётчики операций: выделения памяти, байты, FLOP и время
+
+#ifndef __TStats_H__
+#define __TStats_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "tperf.h"
+
+// Счётчики включаются макросом TMATRIX_STATS (опция CMake TMATRIX_STATS);
+// без него макросы инструментирования пусты, а снимок содержит нули.
+// TMATRIX_PERF дополнительно снимает аппаратные счётчики (tperf.h)
+// с каждой внешней операции
+#if defined(TMATRIX_PERF) && !defined(TMATRIX_STATS)
+#define TMATRIX_STATS
+#endif
+
+// Класс операции
+enum class TOpKind
+{
+  Add,        // поэлементное сложение
+  Sub,        // поэлементное вычитание
+  ScalarMul,  // умножение на скаляр и сдвиг на скаляр
+  Dot,        // скалярное произведение и редукции
+  Gemv,       // матрица на вектор
+  Gemm,       // матрица на матрицу
+  Copy,       // копирование
+  IO,         // ввод/вывод
+  Count
+};
+
+const size_t OP_KIND_COUNT = static_cast<size_t>(TOpKind::Count);
+
+inline const char* op_kind_name(TOpKind kind)
+{
+  static const char* names[OP_KIND_COUNT] = { "add", "sub", "scalar_mul", "dot", "gemv", "gemm", "copy", "io" };
+  return names[static_cast<size_t>(kind)];
+}
+
+// Показатели одного класса операций
+struct TOpStats
+{
+  uint64_t calls = 0;
+  uint64_t flops = 0;
+  uint64_t bytes = 0;        // оценка прочитанных и записанных байт
+  uint64_t nanoseconds = 0;
+  TPerfSample hw;            // аппаратные счётчики, только с TMATRIX_PERF
+};
+
+// Снимок всех счётчиков
+struct TStatsSnapshot
+{
+  uint64_t allocations = 0;
+  uint64_t bytesAllocated = 0;
+  TOpStats ops[OP_KIND_COUNT];
+
+  const TOpStats& operator[](TOpKind kind) const { return ops[static_cast<size_t>(kind)]; }
+};
+
+namespace stats_detail
+{
+  struct TCounters
+  {
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> bytesAllocated{ 0 };
+    std::atomic<uint64_t> calls[OP_KIND_COUNT] = {};
+    std::atomic<uint64_t> flops[OP_KIND_COUNT] = {};
+    std::atomic<uint64_t> bytes[OP_KIND_COUNT] = {};
+    std::atomic<uint64_t> nanoseconds[OP_KIND_COUNT] = {};
+    std::atomic<uint64_t> cycles[OP_KIND_COUNT] = {};
+    std::atomic<uint64_t> instructions[OP_KIND_COUNT] = {};
+    std::atomic<uint64_t> cacheMisses[OP_KIND_COUNT] = {};
+    std::atomic<uint64_t> branchMisses[OP_KIND_COUNT] = {};
+  };
+
+  inline TCounters& counters()
+  {
+    static TCounters c;
+    return c;
+  }
+
+#ifdef TMATRIX_PERF
+  // счётчики главного потока открываются при статической инициализации,
+  // до создания пула OpenMP, чтобы рабочие потоки их унаследовали и
+  // параллельные операции учитывались целиком
+  inline TPerfCounters& mainPerfCounters = thread_perf_counters();
+#endif
+
+  inline void count_alloc(uint64_t bytes)
+  {
+    TCounters& c = counters();
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  // Учитываемая операция. Вложенные операции (строки матрицы внутри
+  // матричной операции) не учитываются отдельно: их FLOP и байты
+  // добавляются к внешней операции текущего потока. Заглушка (конструктор
+  // без аргументов) поглощает вложенные операции в рабочих потоках
+  // параллельного цикла, когда внешняя операция уже учла всю работу
+  class TScopedOp
+  {
+    size_t kind;
+    uint64_t flops, bytes;
+    TScopedOp* parent;
+    bool muted;
+    std::chrono::steady_clock::time_point start;
+#ifdef TMATRIX_PERF
+    TPerfSample hwStart;
+#endif
+
+    static TScopedOp*& current()
+    {
+      thread_local TScopedOp* op = nullptr;
+      return op;
+    }
+
+  public:
+    TScopedOp(TOpKind k, uint64_t f, uint64_t b)
+      : kind(static_cast<size_t>(k)), flops(f), bytes(b), parent(current()), muted(false)
+    {
+      current() = this;
+      if (parent) return;
+#ifdef TMATRIX_PERF
+      hwStart = thread_perf_counters().read();
+#endif
+      start = std::chrono::steady_clock::now();
+    }
+    TScopedOp() : kind(0), flops(0), bytes(0), parent(current()), muted(true)
+    {
+      current() = this;
+    }
+    ~TScopedOp()
+    {
+      current() = parent;
+      if (muted) return;
+      if (parent) {
+        parent->flops += flops;
+        parent->bytes += bytes;
+        return;
+      }
+      uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+      TCounters& c = counters();
+      c.calls[kind].fetch_add(1, std::memory_order_relaxed);
+      c.flops[kind].fetch_add(flops, std::memory_order_relaxed);
+      c.bytes[kind].fetch_add(bytes, std::memory_order_relaxed);
+      c.nanoseconds[kind].fetch_add(ns, std::memory_order_relaxed);
+#ifdef TMATRIX_PERF
+      TPerfSample hw = thread_perf_counters().read() - hwStart;
+      c.cycles[kind].fetch_add(hw.cycles, std::memory_order_relaxed);
+      c.instructions[kind].fetch_add(hw.instructions, std::memory_order_relaxed);
+      c.cacheMisses[kind].fetch_add(hw.cacheMisses, std::memory_order_relaxed);
+      c.branchMisses[kind].fetch_add(hw.branchMisses, std::memory_order_relaxed);
+#endif
+    }
+    TScopedOp(const TScopedOp&) = delete;
+    TScopedOp& operator=(const TScopedOp&) = delete;
+  };
+}
+
+#ifdef TMATRIX_STATS
+#define TMATRIX_MUTE_STATS() stats_detail::TScopedOp tmatrixMutedOp_
+#define TMATRIX_COUNT_ALLOC(bytes) stats_detail::count_alloc(static_cast<uint64_t>(bytes))
+#define TMATRIX_SCOPED_OP(kind, flops, bytes) \
+  stats_detail::TScopedOp tmatrixScopedOp_(kind, static_cast<uint64_t>(flops), static_cast<uint64_t>(bytes))
+#else
+// аргументы не вычисляются (sizeof), но переменные, нужные только
+// счётчикам, не считаются неиспользуемыми
+#define TMATRIX_MUTE_STATS() ((void)0)
+#define TMATRIX_COUNT_ALLOC(bytes) ((void)sizeof(bytes))
+#define TMATRIX_SCOPED_OP(kind, flops, bytes) ((void)sizeof(kind), (void)sizeof(flops), (void)sizeof(bytes))
+#endif
+
+inline constexpr bool perf_enabled()
+{
+#ifdef TMATRIX_PERF
+  return true;
+#else
+  return false;
+#endif
+}
+
+inline constexpr bool stats_enabled()
+{
+#ifdef TMATRIX_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Текущие значения счётчиков
+inline TStatsSnapshot stats_snapshot()
+{
+  TStatsSnapshot s;
+  stats_detail::TCounters& c = stats_detail::counters();
+  s.allocations = c.allocations.load(std::memory_order_relaxed);
+  s.bytesAllocated = c.bytesAllocated.load(std::memory_order_relaxed);
+  for (size_t k = 0; k < OP_KIND_COUNT; ++k) {
+    s.ops[k].calls = c.calls[k].load(std::memory_order_relaxed);
+    s.ops[k].flops = c.flops[k].load(std::memory_order_relaxed);
+    s.ops[k].bytes = c.bytes[k].load(std::memory_order_relaxed);
+    s.ops[k].nanoseconds = c.nanoseconds[k].load(std::memory_order_relaxed);
+    s.ops[k].hw.cycles = c.cycles[k].load(std::memory_order_relaxed);
+    s.ops[k].hw.instructions = c.instructions[k].load(std::memory_order_relaxed);
+    s.ops[k].hw.cacheMisses = c.cacheMisses[k].load(std::memory_order_relaxed);
+    s.ops[k].hw.branchMisses = c.branchMisses[k].load(std::memory_order_relaxed);
+  }
+  return s;
+}
+
+inline void stats_reset()
+{
+  stats_detail::TCounters& c = stats_detail::counters();
+  c.allocations.store(0, std::memory_order_relaxed);
+  c.bytesAllocated.store(0, std::memory_order_relaxed);
+  for (size_t k = 0; k < OP_KIND_COUNT; ++k) {
+    c.calls[k].store(0, std::memory_order_relaxed);
+    c.flops[k].store(0, std::memory_order_relaxed);
+    c.bytes[k].store(0, std::memory_order_relaxed);
+    c.nanoseconds[k].store(0, std::memory_order_relaxed);
+    c.cycles[k].store(0, std::memory_order_relaxed);
+    c.instructions[k].store(0, std::memory_order_relaxed);
+    c.cacheMisses[k].store(0, std::memory_order_relaxed);
+    c.branchMisses[k].store(0, std::memory_order_relaxed);
+  }
+}
+
+#endif
@@ -0,0 +1,230 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Трассировка операций библиотеки и экспорт в формат Chrome trace (Perfetto)
+
+#ifndef __TTrace_H__
+#define __TTrace_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Ёмкость буфера событий одного потока; события сверх неё отбрасываются
+// и учитываются в trace_dropped()
+#ifndef TMATRIX_TRACE_BUFFER_EVENTS
+#define TMATRIX_TRACE_BUFFER_EVENTS 65536
+#endif
+
+// Завершённое событие трассы
+struct TTraceEvent
+{
+  const char* name = nullptr;
+  uint32_t thread = 0;       // порядковый номер потока в трассе
+  uint64_t start = 0;        // нс от trace_start()
+  uint64_t duration = 0;     // нс
+};
+
+namespace trace_detail
+{
+  using clock = std::chrono::steady_clock;
+
+  inline uint64_t now_ns()
+  {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      clock::now().time_since_epoch()).count());
+  }
+
+  // Буфер пишет только поток-владелец; размер публикуется с release,
+  // поэтому экспорт может читать уже записанные события без блокировок
+  struct TBuffer
+  {
+    uint32_t thread;
+    std::unique_ptr<TTraceEvent[]> events;
+    std::atomic<size_t> size{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+
+    explicit TBuffer(uint32_t t) : thread(t), events(new TTraceEvent[TMATRIX_TRACE_BUFFER_EVENTS]) {}
+  };
+
+  struct TRegistry
+  {
+    std::atomic<bool> enabled{ false };
+    std::atomic<uint64_t> epoch{ 0 };
+    std::mutex mutex;                         // только регистрация потоков и экспорт
+    std::vector<std::shared_ptr<TBuffer>> buffers;
+  };
+
+  inline TRegistry& registry()
+  {
+    static TRegistry r;
+    return r;
+  }
+
+  // Буфер регистрируется при первом событии потока и переживает поток,
+  // чтобы его события попали в экспорт
+  inline TBuffer& local_buffer()
+  {
+    thread_local std::shared_ptr<TBuffer> buffer = [] {
+      TRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      r.buffers.push_back(std::make_shared<TBuffer>(static_cast<uint32_t>(r.buffers.size())));
+      return r.buffers.back();
+    }();
+    return *buffer;
+  }
+
+  inline size_t& depth()
+  {
+    thread_local size_t d = 0;
+    return d;
+  }
+
+  inline void record(const char* name, uint64_t start, uint64_t end)
+  {
+    TBuffer& b = local_buffer();
+    size_t n = b.size.load(std::memory_order_relaxed);
+    if (n == TMATRIX_TRACE_BUFFER_EVENTS) {
+      b.dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    uint64_t epoch = registry().epoch.load(std::memory_order_relaxed);
+    TTraceEvent& e = b.events[n];
+    e.name = name;
+    e.thread = b.thread;
+    e.start = start > epoch ? start - epoch : 0;
+    e.duration = end - start;
+    b.size.store(n + 1, std::memory_order_release);
+  }
+
+  // Интервал операции. При выключенной трассировке стоит одной проверки
+  // флага; topOnly - событие пишется только вне других интервалов потока
+  // (операции над строками внутри матричной операции не засоряют трассу)
+  class TTraceScope
+  {
+    const char* name;
+    uint64_t start;
+  public:
+    TTraceScope(const char* n, bool topOnly = false) : name(nullptr), start(0)
+    {
+      if (!registry().enabled.load(std::memory_order_relaxed)) return;
+      if (depth()++ == 0 || !topOnly) name = n;
+      start = now_ns();
+    }
+    ~TTraceScope()
+    {
+      if (!start) return;
+      --depth();
+      if (name) record(name, start, now_ns());
+    }
+    TTraceScope(const TTraceScope&) = delete;
+    TTraceScope& operator=(const TTraceScope&) = delete;
+  };
+
+  inline void write_escaped(std::ostream& out, const char* s)
+  {
+    for (; *s; ++s) {
+      if (*s == '"' || *s == '\\') out << '\\';
+      out << *s;
+    }
+  }
+
+  // нс -> мкс с тремя знаками после точки
+  inline void write_us(std::ostream& out, uint64_t ns)
+  {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu.%03llu",
+      static_cast<unsigned long long>(ns / 1000), static_cast<unsigned long long>(ns % 1000));
+    out << buf;
+  }
+}
+
+// Трассировка компилируется всегда, кроме сборки с TMATRIX_NO_TRACE,
+// и включается во время выполнения функцией trace_start()
+#ifndef TMATRIX_NO_TRACE
+#define TMATRIX_TRACE(name) trace_detail::TTraceScope tmatrixTraceScope_(name)
+#define TMATRIX_TRACE_TOP(name) trace_detail::TTraceScope tmatrixTraceScope_(name, true)
+#else
+#define TMATRIX_TRACE(name) ((void)0)
+#define TMATRIX_TRACE_TOP(name) ((void)0)
+#endif
+
+inline bool trace_enabled()
+{
+  return trace_detail::registry().enabled.load(std::memory_order_relaxed);
+}
+
+// Начать запись; отсчёт времени событий ведётся от момента вызова
+inline void trace_start()
+{
+  trace_detail::TRegistry& r = trace_detail::registry();
+  r.epoch.store(trace_detail::now_ns(), std::memory_order_relaxed);
+  r.enabled.store(true, std::memory_order_relaxed);
+}
+
+inline void trace_stop()
+{
+  trace_detail::registry().enabled.store(false, std::memory_order_relaxed);
+}
+
+// Очистить буферы; вызывается, когда никакой поток не пишет события
+inline void trace_clear()
+{
+  trace_detail::TRegistry& r = trace_detail::registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (auto& b : r.buffers) {
+    b->size.store(0, std::memory_order_relaxed);
+    b->dropped.store(0, std::memory_order_relaxed);
+  }
+}
+
+// Все записанные события, по потокам в порядке завершения
+inline std::vector<TTraceEvent> trace_events()
+{
+  trace_detail::TRegistry& r = trace_detail::registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  std::vector<TTraceEvent> events;
+  for (auto& b : r.buffers) {
+    size_t n = b->size.load(std::memory_order_acquire);
+    events.insert(events.end(), b->events.get(), b->events.get() + n);
+  }
+  return events;
+}
+
+// Число событий, не поместившихся в буферы
+inline uint64_t trace_dropped()
+{
+  trace_detail::TRegistry& r = trace_detail::registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  uint64_t dropped = 0;
+  for (auto& b : r.buffers)
+    dropped += b->dropped.load(std::memory_order_relaxed);
+  return dropped;
+}
+
+// Экспорт в JSON формата Chrome trace (chrome://tracing, ui.perfetto.dev)
+inline void trace_write_chrome(std::ostream& out)
+{
+  std::vector<TTraceEvent> events = trace_events();
+  out << "{\"traceEvents\":[";
+  for (size_t i = 0; i < events.size(); ++i) {
+    const TTraceEvent& e = events[i];
+    if (i) out << ',';
+    out << "\n{\"name\":\"";
+    trace_detail::write_escaped(out, e.name);
+    out << "\",\"cat\":\"tmatrix\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread << ",\"ts\":";
+    trace_detail::write_us(out, e.start);
+    out << ",\"dur\":";
+    trace_detail::write_us(out, e.duration);
+    out << '}';
+  }
+  out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+#endif
@@ -0,0 +1,318 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Замеры производительности операций с векторами и матрицами
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "tmatrix.h"
+#include "tbatch.h"
+#include "tfactor.h"
+#include "tbanded.h"
+#include "tperf.h"
+#include "thalf.h"
+
+template<typename F>
+double measure_ms(F f, int repeats = 10)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; ++r)
+    f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repeats;
+}
+
+void bench_reductions()
+{
+  const size_t n = 10000000;
+  TDynamicVector<float> a(n), b(n);
+  for (size_t i = 0; i < n; ++i) {
+    a[i] = static_cast<float>(i % 1000) * 1e-3f;
+    b[i] = static_cast<float>(i % 7) - 3.0f;
+  }
+
+  const TSumMode modes[] = { TSumMode::Fast, TSumMode::Pairwise, TSumMode::Kahan,
+    TSumMode::Parallel, TSumMode::Reproducible };
+  const char* names[] = { "fast", "pairwise", "kahan", "parallel", "reproducible" };
+  double times[5];
+  volatile float sink = 0;
+
+  cout << "dot product, n = " << n << endl;
+  for (int m = 0; m < 5; ++m) {
+    times[m] = measure_ms([&] { sink = a.dot(b, modes[m]); });
+    cout << "  " << names[m] << ": " << times[m] << " ms" << endl;
+  }
+  cout << "  reproducible / parallel: " << times[4] / times[3] << endl;
+}
+
+// поэлементные операции и циклы записи через operator[]: учёт версий
+// и хешей не должен замедлять их
+void bench_elementwise()
+{
+  const size_t n = 10000000, m = 4000;
+  TDynamicVector<float> a(n), b(n), c(n);
+  for (size_t i = 0; i < n; ++i) {
+    a[i] = static_cast<float>(i % 100);
+    b[i] = static_cast<float>(i % 7);
+  }
+  TDynamicMatrix<float> x(m);
+
+  cout << "elementwise, n = " << n << endl;
+  cout << "  vector +: " << measure_ms([&] { c = a + b; }, 5) << " ms" << endl;
+  cout << "  vector * scalar: " << measure_ms([&] { c = a * 2.0f; }, 5) << " ms" << endl;
+  cout << "  vector fill loop: " << measure_ms([&] {
+    for (size_t i = 0; i < n; ++i)
+      c[i] = static_cast<float>(i);
+  }, 5) << " ms" << endl;
+  cout << "  matrix " << m << "x" << m << " fill loop: " << measure_ms([&] {
+    for (size_t i = 0; i < m; ++i)
+      for (size_t j = 0; j < m; ++j)
+        x[i][j] = static_cast<float>(i + j);
+  }, 5) << " ms" << endl;
+}
+
+void bench_batched_gemm()
+{
+  const size_t n = 8, count = 100000;
+  TMatrixBatch<float> a(n, count), b(n, count), c(n, count);
+  for (size_t k = 0; k < count; ++k)
+    for (size_t i = 0; i < n; ++i)
+      for (size_t j = 0; j < n; ++j) {
+        a(k, i, j) = static_cast<float>((i + j + k) % 5);
+        b(k, i, j) = static_cast<float>((i * j + k) % 3);
+      }
+  TDynamicMatrix<float> ma = a.get(0), mb = b.get(0), mc(n);
+
+  cout << "batched gemm, " << count << " products " << n << "x" << n << endl;
+  cout << "  batch_multiply: " << measure_ms([&] { batch_multiply(a, b, c); }, 3) << " ms" << endl;
+  cout << "  operator* loop: " << measure_ms([&] {
+    for (size_t k = 0; k < count; ++k)
+      mc = ma * mb;
+  }, 1) << " ms" << endl;
+}
+
+void bench_gemv(size_t n)
+{
+  TDynamicMatrix<double> a(n);
+  TDynamicVector<double> x(n), y(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = static_cast<double>(i % 13);
+    for (size_t j = 0; j < n; ++j)
+      a[i][j] = static_cast<double>((i + j) % 10);
+  }
+
+  cout << "gemv " << n << "x" << n << endl;
+  cout << "  row dot loop: " << measure_ms([&] {
+    for (size_t i = 0; i < n; ++i)
+      y[i] = a[i].dot(x);
+  }, 20) << " ms" << endl;
+  double ms = measure_ms([&] { y = a * x; }, 20);
+  cout << "  operator*: " << ms << " ms, " << n * n * sizeof(double) / ms / 1e6 << " GB/s" << endl;
+  cout << "  left_multiply: " << measure_ms([&] { y = a.left_multiply(x); }, 20) << " ms" << endl;
+}
+
+void bench_half_gemv(size_t n)
+{
+  TDynamicMatrix<float> a(n);
+  TDynamicVector<float> x(n), y(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = static_cast<float>(i % 13);
+    for (size_t j = 0; j < n; ++j)
+      a[i][j] = static_cast<float>((i + j) % 10);
+  }
+  TDynamicMatrix<TFloat16> h(n);
+  TDynamicMatrix<TBFloat16> b(n);
+  for (size_t i = 0; i < n; ++i) {
+    from_float(&a[i][0], &h[i][0], n);
+    from_float(&a[i][0], &b[i][0], n);
+  }
+
+  cout << "half gemv " << n << "x" << n << endl;
+  double ms = measure_ms([&] { y = a * x; }, 20);
+  cout << "  float: " << ms << " ms, " << n * n * sizeof(float) / ms / 1e6 << " GB/s" << endl;
+  ms = measure_ms([&] { gemv_f32(h, x, y); }, 20);
+  cout << "  float16: " << ms << " ms, " << n * n * sizeof(TFloat16) / ms / 1e6 << " GB/s" << endl;
+  ms = measure_ms([&] { gemv_f32(b, x, y); }, 20);
+  cout << "  bfloat16: " << ms << " ms, " << n * n * sizeof(TBFloat16) / ms / 1e6 << " GB/s" << endl;
+}
+
+void bench_compare()
+{
+  const size_t n = 4000;
+  TDynamicMatrix<double> a(n), b(n);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      a[i][j] = b[i][j] = static_cast<double>(i ^ j);
+  volatile bool sink = false;
+
+  cout << "compare " << n << "x" << n << endl;
+  cout << "  operator==: " << measure_ms([&] { sink = a == b; }) << " ms" << endl;
+  b.hash();
+  cout << "  approx_equal: " << measure_ms([&] { sink = approx_equal(a, b); }) << " ms" << endl;
+  cout << "  hash: " << measure_ms([&] { sink = a.hash() != 0; }, 1) << " ms" << endl;
+  cout << "  hash after one row changed: " << measure_ms([&] { a[0][0] += 1.0; sink = a.hash() != 0; }) << " ms" << endl;
+  cout << "  == of different hashed matrices: " << measure_ms([&] { sink = a == b; }) << " ms" << endl;
+}
+
+void bench_product_cache()
+{
+  const size_t n = 300;
+  TDynamicMatrix<double> a(n), b(n), c(n);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j) {
+      a[i][j] = static_cast<double>(i + j) / n;
+      b[i][j] = static_cast<double>(i * j % 7);
+    }
+
+  cout << "product cache " << n << "x" << n << endl;
+  cout << "  gemm without cache: " << measure_ms([&] { c = a * b; }, 3) << " ms" << endl;
+  TProductCache<double> cache(64 << 20);
+  TProductCache<double>::install(&cache);
+  cout << "  gemm with cache: " << measure_ms([&] { c = a * b; }, 3) << " ms" << endl;
+  TCacheStats s = cache.stats();
+  cout << "  hits " << s.hits << ", misses " << s.misses << ", " << s.bytes << " bytes" << endl;
+  TProductCache<double>::install(nullptr);
+}
+
+void bench_low_rank_update()
+{
+  const size_t n = 500;
+  TDynamicMatrix<double> a(n);
+  TDynamicVector<double> x(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = static_cast<double>(i % 7) / n;
+    for (size_t j = 0; j < n; ++j)
+      a[i][j] = static_cast<double>((i * j) % 5) / n;
+    a[i][i] += 1.0;
+  }
+  TDynamicMatrix<double> spd = gram(a);
+  TCholesky<double> ch(spd);
+  TLU<double> lu(a);
+
+  cout << "low rank update " << n << "x" << n << endl;
+  cout << "  cholesky: " << measure_ms([&] { TCholesky<double> f(spd); }, 3) << " ms" << endl;
+  cout << "  cholesky update + downdate: " << measure_ms([&] { ch.update(x); ch.downdate(x); }, 3) << " ms" << endl;
+  cout << "  lu: " << measure_ms([&] { TLU<double> f(a); }, 3) << " ms" << endl;
+  cout << "  lu rank-1 update: " << measure_ms([&] { lu.update(1e-3, x, x); }, 3) << " ms" << endl;
+}
+
+void bench_banded()
+{
+  const size_t n = 10000000;
+  TTridiagonalMatrix<double> t(n);
+  TBandMatrix<double> b(n, 4, 4);
+  TDynamicVector<double> x(n), y(n);
+  for (size_t i = 0; i < n; ++i) {
+    t.lower_diagonal()[i] = -1.0;
+    t.main_diagonal()[i] = 4.0;
+    t.upper_diagonal()[i] = -1.0;
+    x[i] = static_cast<double>(i % 13);
+  }
+  for (ptrdiff_t d = -4; d <= 4; ++d) {
+    TDynamicVector<double>& diag = b.diagonal(d);
+    for (size_t i = 0; i < n; ++i)
+      diag[i] = d == 0 ? 10.0 : -1.0;
+  }
+
+  cout << "banded n = " << n << endl;
+  cout << "  tridiagonal gemv: " << measure_ms([&] { t.multiply_into(x, y); }, 3) << " ms" << endl;
+  cout << "  thomas solve: " << measure_ms([&] { t.solve_into(x, y); }, 3) << " ms" << endl;
+  cout << "  band (4, 4) gemv: " << measure_ms([&] { b.multiply_into(x, y); }, 3) << " ms" << endl;
+  TBandLU<double> lu(b);
+  cout << "  band (4, 4) lu solve: " << measure_ms([&] { lu.solve_into(x, y); }, 3) << " ms" << endl;
+}
+
+void bench_transpose()
+{
+  const size_t n = 4000;
+  TDynamicMatrix<float> a(n), b(n);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      a[i][j] = static_cast<float>(i + j);
+
+  cout << "transpose " << n << "x" << n << endl;
+  cout << "  naive: " << measure_ms([&] {
+    for (size_t i = 0; i < n; ++i)
+      for (size_t j = 0; j < n; ++j)
+        b[j][i] = a[i][j];
+  }, 3) << " ms" << endl;
+  cout << "  transposed(): " << measure_ms([&] { b = a.transposed(); }, 3) << " ms" << endl;
+  cout << "  transpose() in place: " << measure_ms([&] { a.transpose(); }, 3) << " ms" << endl;
+}
+
+void bench_gemm_counters()
+{
+  const size_t n = 300;
+  TDynamicMatrix<double> a(n), b(n), c(n);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j) {
+      a[i][j] = static_cast<double>((i + j) % 10);
+      b[i][j] = static_cast<double>((i * j) % 7);
+    }
+
+  TPerfCounters& perf = thread_perf_counters();
+  cout << "gemm " << n << "x" << n << " hardware counters" << endl;
+  if (!perf.available()) {
+    cout << "  perf_event_open is not available" << endl;
+    return;
+  }
+  TPerfSample start = perf.read();
+  c = a * b;
+  TPerfSample hw = perf.read() - start;
+  double flops = 2.0 * n * n * n;
+  cout << "  cycles/flop: " << hw.cycles / flops << endl;
+  cout << "  instructions/cycle: " << static_cast<double>(hw.instructions) / hw.cycles << endl;
+  cout << "  cache misses: " << hw.cacheMisses << endl;
+  cout << "  branch misses: " << hw.branchMisses << endl;
+}
+
+#ifdef TMATRIX_STATS
+void print_stats()
+{
+  TStatsSnapshot s = stats_snapshot();
+  cout << "library stats: " << s.allocations << " allocations, " << s.bytesAllocated << " bytes" << endl;
+  for (size_t k = 0; k < OP_KIND_COUNT; ++k) {
+    const TOpStats& op = s.ops[k];
+    if (op.calls == 0) continue;
+    cout << "  " << op_kind_name(static_cast<TOpKind>(k)) << ": " << op.calls << " calls, "
+      << op.flops << " flops, " << op.nanoseconds / 1e6 << " ms";
+    if (perf_enabled() && op.flops > 0)
+      cout << ", " << static_cast<double>(op.hw.cycles) / op.flops << " cycles/flop, "
+        << op.hw.cacheMisses << " cache misses";
+    cout << endl;
+  }
+}
+#endif
+
+// bench_matrix --trace out.json записывает трассу операций
+int main(int argc, char** argv)
+{
+  const char* tracePath = nullptr;
+  for (int i = 1; i + 1 < argc; ++i)
+    if (std::strcmp(argv[i], "--trace") == 0) tracePath = argv[i + 1];
+  if (tracePath) trace_start();
+
+  bench_reductions();
+  bench_elementwise();
+  bench_batched_gemm();
+  bench_gemv(500);
+  bench_gemv(4000);
+  bench_half_gemv(4000);
+  bench_compare();
+  bench_product_cache();
+  bench_low_rank_update();
+  bench_banded();
+  bench_transpose();
+  bench_gemm_counters();
+#ifdef TMATRIX_STATS
+  print_stats();
+#endif
+  if (tracePath) {
+    trace_stop();
+    std::ofstream out(tracePath);
+    trace_write_chrome(out);
+  }
+  return 0;
+}
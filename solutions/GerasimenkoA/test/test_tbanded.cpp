@@ -0,0 +1,204 @@
+#include "tbanded.h"
+#include "tsolvers.h"
+
+#include <gtest.h>
+
+// ленточная матрица с диагональным преобладанием
+static TBandMatrix<double> make_band(size_t n, size_t kl, size_t ku, size_t seed)
+{
+	TBandMatrix<double> b(n, kl, ku);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = i > kl ? i - kl : 0; j < std::min(n, i + ku + 1); ++j)
+			b.at(i, j) = i == j ? 4.0 * (kl + ku + 1) : static_cast<double>((i * 3 + j * 5 + seed) % 7) - 3.0;
+	return b;
+}
+
+static TDynamicVector<double> make_band_vector(size_t n)
+{
+	TDynamicVector<double> v(n);
+	for (size_t i = 0; i < n; ++i)
+		v[i] = static_cast<double>(i % 9) - 4.0;
+	return v;
+}
+
+TEST(TBandMatrix, can_create_band_matrix)
+{
+	ASSERT_NO_THROW(TBandMatrix<double> b(10, 2, 3));
+}
+
+TEST(TBandMatrix, throws_when_size_is_zero_or_too_large)
+{
+	ASSERT_ANY_THROW(TBandMatrix<double> b(0, 1, 1));
+	ASSERT_ANY_THROW(TBandMatrix<double> b(MAX_VECTOR_SIZE + 1, 1, 1));
+}
+
+TEST(TBandMatrix, size_is_not_limited_by_dense_maximum)
+{
+	TBandMatrix<float> b(MAX_MATRIX_SIZE * 10, 1, 1);
+	EXPECT_EQ(MAX_MATRIX_SIZE * 10, b.size());
+}
+
+TEST(TBandMatrix, elements_outside_band_are_zero_and_read_only)
+{
+	TBandMatrix<int> b(6, 1, 2);
+	b.at(3, 5) = 7;
+	b.at(3, 2) = 4;
+
+	EXPECT_EQ(7, b.get(3, 5));
+	EXPECT_EQ(4, b.get(3, 2));
+	EXPECT_EQ(0, b.get(3, 1));
+	EXPECT_EQ(0, b.get(0, 5));
+	ASSERT_ANY_THROW(b.at(3, 1));
+	ASSERT_ANY_THROW(b.at(3, 6));
+	ASSERT_ANY_THROW(b.diagonal(3));
+	EXPECT_EQ(7, b.diagonal(2)[3]);
+}
+
+TEST(TBandMatrix, dense_round_trip)
+{
+	TBandMatrix<double> b = make_band(12, 2, 1, 1);
+	TDynamicMatrix<double> d = b.to_dense();
+
+	EXPECT_EQ(0.0, d[0][5]);
+	EXPECT_EQ(b, TBandMatrix<double>::from_dense(d, 2, 1));
+}
+
+TEST(TBandMatrix, multiply_by_vector_matches_dense)
+{
+	const size_t n = 9000;
+	TBandMatrix<double> b = make_band(n, 3, 2, 2);
+	TDynamicVector<double> x = make_band_vector(n);
+	TDynamicMatrix<double> d = b.to_dense();
+
+	EXPECT_EQ(d * x, b * x);
+}
+
+TEST(TBandMatrix, add_and_subtract_use_union_of_bands)
+{
+	TBandMatrix<double> a = make_band(15, 1, 3, 1), b = make_band(15, 2, 0, 2);
+
+	TBandMatrix<double> s = a + b, r = a - b;
+
+	EXPECT_EQ(2, s.lower_bandwidth());
+	EXPECT_EQ(3, s.upper_bandwidth());
+	EXPECT_EQ(a.to_dense() + b.to_dense(), s.to_dense());
+	EXPECT_EQ(a.to_dense() - b.to_dense(), r.to_dense());
+	EXPECT_EQ(a.to_dense() * 2.0, (a * 2.0).to_dense());
+}
+
+TEST(TBandMatrix, band_product_matches_dense)
+{
+	const size_t n = 20;
+	TBandMatrix<double> a = make_band(n, 2, 1, 3), b = make_band(n, 1, 3, 4);
+
+	TBandMatrix<double> c = a * b;
+
+	EXPECT_EQ(3, c.lower_bandwidth());
+	EXPECT_EQ(4, c.upper_bandwidth());
+	EXPECT_EQ(a.to_dense() * b.to_dense(), c.to_dense());
+}
+
+TEST(TBandMatrix, band_product_width_is_limited_by_size)
+{
+	TBandMatrix<double> a = make_band(4, 3, 3, 1);
+	TBandMatrix<double> c = a * a;
+	EXPECT_EQ(3, c.upper_bandwidth());
+	EXPECT_EQ(a.to_dense() * a.to_dense(), c.to_dense());
+}
+
+TEST(TBandMatrix, works_with_iterative_solvers)
+{
+	const size_t n = 500;
+	TBandMatrix<double> a = make_band(n, 2, 2, 0);
+	a = a + TBandMatrix<double>::from_dense(a.to_dense().transposed(), 2, 2);
+	TDynamicVector<double> x = make_band_vector(n), b = a * x, sol(n);
+
+	TSolverResult<double> res = cg(make_operator(a), b, sol);
+
+	EXPECT_TRUE(res.converged);
+	EXPECT_TRUE(approx_equal(x, sol, 1e-5, 1e-6));
+}
+
+TEST(TBandLU, solves_band_system)
+{
+	const size_t n = 2000;
+	TBandMatrix<double> a = make_band(n, 4, 3, 5);
+	TDynamicVector<double> x = make_band_vector(n);
+
+	TBandLU<double> lu(a);
+
+	EXPECT_TRUE(approx_equal(x, lu.solve(a * x), 1e-10, 1e-10));
+	EXPECT_EQ(4, lu.factors().lower_bandwidth());
+}
+
+TEST(TBandLU, throws_on_zero_pivot)
+{
+	TBandMatrix<double> a(3, 1, 1);
+	ASSERT_ANY_THROW(TBandLU<double> lu(a));
+}
+
+TEST(TTridiagonalMatrix, thomas_solve_matches_band_lu)
+{
+	const size_t n = 1000;
+	TTridiagonalMatrix<double> t(n);
+	for (size_t i = 0; i < n; ++i) {
+		t.lower_diagonal()[i] = i > 0 ? -1.0 : 0.0;
+		t.main_diagonal()[i] = 2.5 + i % 3;
+		t.upper_diagonal()[i] = i + 1 < n ? -1.0 - 0.1 * (i % 2) : 0.0;
+	}
+	TDynamicVector<double> x = make_band_vector(n);
+	TDynamicVector<double> b = t * x;
+
+	EXPECT_TRUE(approx_equal(x, t.solve(b), 1e-12, 1e-12));
+	EXPECT_TRUE(approx_equal(TBandLU<double>(t).solve(b), t.solve(b), 1e-12, 1e-12));
+}
+
+TEST(TTridiagonalMatrix, solves_one_by_one_system)
+{
+	TTridiagonalMatrix<double> t(1);
+	t.main_diagonal()[0] = 4.0;
+	TDynamicVector<double> b(1);
+	b[0] = 2.0;
+	EXPECT_DOUBLE_EQ(0.5, t.solve(b)[0]);
+}
+
+TEST(TTridiagonalMatrix, throws_on_zero_pivot)
+{
+	TTridiagonalMatrix<double> t(4);
+	TDynamicVector<double> b(4);
+	ASSERT_ANY_THROW(t.solve(b));
+}
+
+TEST(TTridiagonalMatrix, scales_to_a_million_unknowns)
+{
+	const size_t n = 1000000;
+	TTridiagonalMatrix<double> t(n);
+	TDynamicVector<double> x(n);
+	for (size_t i = 0; i < n; ++i) {
+		t.lower_diagonal()[i] = i > 0 ? -1.0 : 0.0;
+		t.main_diagonal()[i] = 3.0;
+		t.upper_diagonal()[i] = i + 1 < n ? -1.0 : 0.0;
+		x[i] = static_cast<double>(i % 11);
+	}
+
+	EXPECT_TRUE(approx_equal(x, t.solve(t * x), 1e-10, 1e-10));
+}
+
+TEST(TTridiagonalMatrix, solve_into_may_overwrite_right_hand_side)
+{
+	const size_t n = 50;
+	TTridiagonalMatrix<double> t(n);
+	for (size_t i = 0; i < n; ++i) {
+		t.lower_diagonal()[i] = 1.0;
+		t.main_diagonal()[i] = 5.0;
+		t.upper_diagonal()[i] = 2.0;
+	}
+	TDynamicVector<double> x = make_band_vector(n);
+	TDynamicVector<double> b = t * x;
+	TDynamicVector<double> expected = t.solve(b);
+
+	t.solve_into(b, b);
+
+	EXPECT_EQ(expected, b);
+	EXPECT_TRUE(approx_equal(x, b, 1e-12, 1e-12));
+}
@@ -0,0 +1,99 @@
+#include "tbatch.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<double> make_matrix(size_t n, size_t seed)
+{
+	TDynamicMatrix<double> m(n);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			m[i][j] = static_cast<double>((i * 3 + j * 7 + seed * 5) % 13) - 6.0;
+	return m;
+}
+
+TEST(TMatrixBatch, can_set_and_get_matrix)
+{
+	TMatrixBatch<double> batch(3, 10);
+	TDynamicMatrix<double> m = make_matrix(3, 1);
+	batch.set(9, m);
+
+	EXPECT_EQ(m, batch.get(9));
+	EXPECT_EQ(m[2][1], batch(9, 2, 1));
+}
+
+TEST(TMatrixBatch, throws_when_index_is_too_large)
+{
+	TMatrixBatch<double> batch(3, 10);
+	ASSERT_ANY_THROW(batch.get(10));
+}
+
+TEST(TMatrixBatch, can_create_batch_larger_than_max_vector_size)
+{
+	size_t count = MAX_VECTOR_SIZE + 1;
+	TMatrixBatch<unsigned char> batch(1, count);
+	batch(count - 1, 0, 0) = 7;
+
+	EXPECT_EQ(count, batch.count());
+	EXPECT_EQ(7, batch(count - 1, 0, 0));
+}
+
+TEST(TMatrixBatch, throws_when_batch_size_overflows)
+{
+	ASSERT_ANY_THROW(TMatrixBatch<double>(MAX_MATRIX_SIZE, std::numeric_limits<size_t>::max() / 64));
+}
+
+TEST(TMatrixBatch, batch_product_matches_single_products)
+{
+	size_t n = 5, count = 19;
+	TMatrixBatch<double> a(n, count), b(n, count), c(n, count);
+	for (size_t k = 0; k < count; ++k) {
+		a.set(k, make_matrix(n, k));
+		b.set(k, make_matrix(n, k + 100));
+	}
+	batch_multiply(a, b, c);
+
+	for (size_t k = 0; k < count; ++k)
+		EXPECT_EQ(make_matrix(n, k) * make_matrix(n, k + 100), c.get(k));
+}
+
+TEST(TMatrixBatch, cant_multiply_batches_of_different_shape)
+{
+	TMatrixBatch<double> a(3, 4), b(3, 5), c(3, 4);
+	ASSERT_ANY_THROW(batch_multiply(a, b, c));
+}
+
+TEST(TMatrixBatch, cant_multiply_into_operand)
+{
+	TMatrixBatch<double> a(3, 4), b(3, 4);
+	ASSERT_ANY_THROW(batch_multiply(a, b, a));
+	ASSERT_ANY_THROW(batch_multiply(a, b, b));
+}
+
+TEST(TMatrixBatch, strided_product_matches_single_products)
+{
+	size_t n = 4, count = 6, stride = n * n + 3;
+	TDynamicVector<double> a(stride * count), b(stride * count), c(stride * count);
+	for (size_t k = 0; k < count; ++k) {
+		TDynamicMatrix<double> ma = make_matrix(n, k), mb = make_matrix(n, k + 7);
+		for (size_t i = 0; i < n; ++i)
+			for (size_t j = 0; j < n; ++j) {
+				a[k * stride + i * n + j] = ma[i][j];
+				b[k * stride + i * n + j] = mb[i][j];
+			}
+	}
+	gemm_strided_batched(&a[0], stride, &b[0], stride, &c[0], stride, n, count);
+
+	TMatrixBatch<double> packed(n, count);
+	packed.load(&c[0], stride);
+	for (size_t k = 0; k < count; ++k)
+		EXPECT_EQ(make_matrix(n, k) * make_matrix(n, k + 7), packed.get(k));
+}
+
+TEST(TMatrixBatch, strided_product_cant_overlap_operands)
+{
+	size_t n = 3, count = 4, stride = n * n;
+	TDynamicVector<double> a(stride * count), b(stride * count), c(stride * (count + 1));
+	ASSERT_ANY_THROW(gemm_strided_batched(&a[0], stride, &b[0], stride, &a[0], stride, n, count));
+	ASSERT_ANY_THROW(gemm_strided_batched(&a[0], stride, &c[0], stride, &c[stride], stride, n, count));
+	ASSERT_NO_THROW(gemm_strided_batched(&a[0], stride, &b[0], stride, &c[0], stride, n, count));
+}
@@ -0,0 +1,122 @@
+#include "tbitmatrix.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<bool> make_pattern(size_t n, size_t seed)
+{
+	TDynamicMatrix<bool> m(n);
+	size_t x = seed;
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j) {
+			x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+			m[i][j] = (x >> 33) & 1;
+		}
+	return m;
+}
+
+TEST(TBitMatrix, can_set_and_get_element)
+{
+	TBitMatrix m(100);
+	m.set(3, 70, true);
+
+	EXPECT_TRUE(m.get(3, 70));
+	EXPECT_FALSE(m.get(3, 71));
+	EXPECT_EQ(1, m.row_popcount(3));
+}
+
+TEST(TBitMatrix, throws_when_get_element_with_too_large_index)
+{
+	TBitMatrix m(10);
+	ASSERT_ANY_THROW(m.at(10, 0));
+}
+
+TEST(TBitMatrix, converts_to_and_from_bool_matrix)
+{
+	TDynamicMatrix<bool> m = make_pattern(70, 1);
+	EXPECT_EQ(m, TBitMatrix(m).to_matrix());
+}
+
+TEST(TBitMatrix, gf2_product_matches_naive_product)
+{
+	size_t n = 75;
+	TDynamicMatrix<bool> a = make_pattern(n, 1), b = make_pattern(n, 2);
+	TBitMatrix c = TBitMatrix(a) * TBitMatrix(b);
+
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j) {
+			bool x = false;
+			for (size_t k = 0; k < n; ++k)
+				x ^= a[i][k] && b[k][j];
+			EXPECT_EQ(x, c.get(i, j));
+		}
+}
+
+TEST(TBitMatrix, bool_product_matches_naive_product)
+{
+	size_t n = 67;
+	TDynamicMatrix<bool> a = make_pattern(n, 3), b = make_pattern(n, 4);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			b[i][j] = b[i][j] && (i + j) % 5 == 0;
+	TBitMatrix c = TBitMatrix(a).bool_multiply(TBitMatrix(b));
+
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j) {
+			bool x = false;
+			for (size_t k = 0; k < n; ++k)
+				x = x || (a[i][k] && b[k][j]);
+			EXPECT_EQ(x, c.get(i, j));
+		}
+}
+
+TEST(TBitMatrix, row_dot_counts_common_bits)
+{
+	TBitMatrix a(130), b(130);
+	a.set(0, 1, true); a.set(0, 65, true); a.set(0, 129, true);
+	b.set(2, 65, true); b.set(2, 129, true); b.set(2, 3, true);
+
+	EXPECT_EQ(2, a.row_dot(0, b, 2));
+}
+
+TEST(TBitMatrix, identity_has_full_rank)
+{
+	TBitMatrix e(100);
+	for (size_t i = 0; i < 100; ++i)
+		e.set(i, i, true);
+	EXPECT_EQ(100, e.rank());
+}
+
+TEST(TBitMatrix, rank_of_dependent_rows)
+{
+	TBitMatrix m(20);
+	for (size_t i = 0; i < 10; ++i)
+		for (size_t j = 0; j < 20; ++j)
+			m.set(i, j, i == j || (j >= 10 && (i * 7 + j * 3) % 4 == 0));
+	// строки 10..19 - суммы соседних строк 0..9
+	for (size_t i = 10; i < 20; ++i)
+		for (size_t j = 0; j < 20; ++j)
+			m.set(i, j, m.get(i - 10, j) != m.get((i - 9) % 10, j));
+	EXPECT_EQ(10, m.rank());
+}
+
+TEST(TBitMatrix, gauss_produces_reduced_echelon_form)
+{
+	TBitMatrix m(TDynamicMatrix<bool>(make_pattern(40, 5)));
+	size_t r = m.gauss_gf2();
+
+	size_t lastPivot = 0;
+	for (size_t i = 0; i < r; ++i) {
+		size_t p = 0;
+		while (!m.get(i, p)) ++p;
+		if (i > 0) {
+			EXPECT_GT(p, lastPivot);
+		}
+		lastPivot = p;
+		for (size_t k = 0; k < 40; ++k)
+			if (k != i) {
+				EXPECT_FALSE(m.get(k, p));
+			}
+	}
+	for (size_t i = r; i < 40; ++i)
+		EXPECT_EQ(0, m.row_popcount(i));
+}
@@ -0,0 +1,254 @@
+#include "tcache.h"
+#include "tlinalg.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<double> cache_test_matrix(size_t n, double shift)
+{
+	TDynamicMatrix<double> m(n);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			m[i][j] = shift + 0.5 * i - 0.25 * j;
+	return m;
+}
+
+TEST(TProductCache, not_installed_by_default)
+{
+	EXPECT_EQ(nullptr, TProductCache<double>::installed());
+}
+
+TEST(TProductCache, repeated_product_is_a_hit)
+{
+	TProductCache<double> cache(1 << 20);
+	TProductCache<double>::install(&cache);
+	TDynamicMatrix<double> a = cache_test_matrix(8, 1.0), b = cache_test_matrix(8, 2.0);
+
+	TDynamicMatrix<double> first = a * b;
+	TDynamicMatrix<double> second = a * b;
+
+	EXPECT_EQ(first, second);
+	TCacheStats s = cache.stats();
+	EXPECT_EQ(1u, s.misses);
+	EXPECT_EQ(1u, s.hits);
+	EXPECT_EQ(1u, s.entries);
+	EXPECT_EQ(3 * 8 * 8 * sizeof(double), s.bytes);   // результат и копии a, b
+}
+
+TEST(TProductCache, equal_content_in_other_objects_is_a_hit)
+{
+	TProductCache<double> cache(1 << 20);
+	TProductCache<double>::install(&cache);
+	TDynamicMatrix<double> a = cache_test_matrix(6, 1.0);
+	TDynamicVector<double> x(6);
+	for (size_t i = 0; i < 6; ++i)
+		x[i] = 1.0 + i;
+
+	TDynamicVector<double> y = a * x;
+	TDynamicMatrix<double> a2 = cache_test_matrix(6, 1.0);
+	TDynamicVector<double> x2(x);
+
+	EXPECT_EQ(y, a2 * x2);
+	EXPECT_EQ(1u, cache.stats().hits);
+}
+
+TEST(TProductCache, mutated_operand_is_a_miss)
+{
+	TProductCache<double> cache(1 << 20);
+	TProductCache<double>::install(&cache);
+	TDynamicMatrix<double> a = cache_test_matrix(5, 1.0), b = cache_test_matrix(5, 3.0);
+
+	TDynamicMatrix<double> before = a * b;
+	a[2][3] += 1.0;
+	TDynamicMatrix<double> after = a * b;
+
+	TProductCache<double>::install(nullptr);
+	EXPECT_EQ(a * b, after);
+	EXPECT_FALSE(before == after);
+	EXPECT_EQ(0u, cache.stats().hits);
+	EXPECT_EQ(2u, cache.stats().misses);
+}
+
+TEST(TProductCache, write_through_held_row_reference_is_a_miss)
+{
+	TProductCache<double> cache(1 << 20);
+	TProductCache<double>::install(&cache);
+	TDynamicMatrix<double> a = cache_test_matrix(5, 1.0), b = cache_test_matrix(5, 3.0);
+
+	TDynamicVector<double>& r = a[0];
+	TDynamicMatrix<double> before = a * b;
+	r[0] = 100.0;
+	TDynamicMatrix<double> after = a * b;
+
+	TProductCache<double>::install(nullptr);
+	EXPECT_EQ(a * b, after);
+	EXPECT_FALSE(before == after);
+	EXPECT_EQ(0u, cache.stats().hits);
+}
+
+TEST(TProductCache, write_through_element_reference_held_across_product_is_a_miss)
+{
+	TProductCache<double> cache(1 << 20);
+	TProductCache<double>::install(&cache);
+	TDynamicMatrix<double> a = cache_test_matrix(5, 1.0), b = cache_test_matrix(5, 3.0);
+
+	double& e = a[0][0];   // хеш строки, вычисленный в a * b, устареет
+	TDynamicMatrix<double> before = a * b;
+	e = 100.0;
+	TDynamicMatrix<double> after = a * b;
+
+	TProductCache<double>::install(nullptr);
+	EXPECT_EQ(a * b, after);
+	EXPECT_FALSE(before == after);
+	EXPECT_EQ(0u, cache.stats().hits);
+	EXPECT_EQ(2u, cache.stats().misses);
+	EXPECT_EQ(1u, cache.stats().entries);
+}
+
+TEST(TProductCache, gemv_hit_is_checked_against_stored_vector)
+{
+	TProductCache<double> cache(1 << 20);
+	TProductCache<double>::install(&cache);
+	TDynamicMatrix<double> a = cache_test_matrix(6, 1.0);
+	TDynamicVector<double> x(6);
+	for (size_t i = 0; i < 6; ++i)
+		x[i] = 1.0 + i;
+
+	double& e = x[3];
+	TDynamicVector<double> before = a * x;
+	e = -7.0;
+	TDynamicVector<double> after = a * x;
+
+	TProductCache<double>::install(nullptr);
+	EXPECT_EQ(a * x, after);
+	EXPECT_FALSE(before == after);
+	EXPECT_EQ(0u, cache.stats().hits);
+}
+
+TEST(TProductCache, products_with_same_matrix_share_its_copy)
+{
+	const size_t n = 6;
+	TProductCache<double> cache(1 << 20);
+	TProductCache<double>::install(&cache);
+	TDynamicMatrix<double> a = cache_test_matrix(n, 1.0);
+	TDynamicVector<double> x(n), y(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = 1.0 + i;
+		y[i] = 2.0 - i;
+	}
+
+	a * x;
+	a * y;
+
+	TCacheStats s = cache.stats();
+	EXPECT_EQ(2u, s.entries);
+	EXPECT_EQ((n * n + 4 * n) * sizeof(double), s.bytes);
+}
+
+TEST(TProductCache, products_of_different_kind_do_not_collide)
+{
+	TProductCache<double> cache(1 << 20);
+	TProductCache<double>::install(&cache);
+	TDynamicMatrix<double> a = cache_test_matrix(7, 1.0);
+	TDynamicVector<double> x(7);
+	for (size_t i = 0; i < 7; ++i)
+		x[i] = 1.0;
+
+	TDynamicVector<double> ax = a.multiply(x);
+	TDynamicVector<double> xa = a.left_multiply(x);
+	TDynamicVector<double> kahan = a.multiply(x, TSumMode::Kahan);
+
+	TProductCache<double>::install(nullptr);
+	EXPECT_EQ(a.multiply(x), ax);
+	EXPECT_EQ(a.left_multiply(x), xa);
+	EXPECT_EQ(0u, cache.stats().hits);
+	EXPECT_EQ(3u, cache.stats().entries);
+	(void)kahan;
+}
+
+TEST(TProductCache, least_recently_used_is_evicted)
+{
+	// запись хранит результат и копию правого операнда, копия a общая:
+	// a, b, c и два результата занимают весь бюджет
+	const size_t bytes = 4 * 4 * sizeof(double);
+	TProductCache<double> cache(5 * bytes);
+	TProductCache<double>::install(&cache);
+	TDynamicMatrix<double> a = cache_test_matrix(4, 1.0);
+	TDynamicMatrix<double> b = cache_test_matrix(4, 2.0), c = cache_test_matrix(4, 3.0), d = cache_test_matrix(4, 4.0);
+
+	a * b;
+	a * c;
+	a * b;   // b становится последним использованным
+	a * d;   // вытесняет a * c вместе с копией c
+
+	TCacheStats s = cache.stats();
+	EXPECT_EQ(1u, s.evictions);
+	EXPECT_EQ(2u, s.entries);
+	EXPECT_EQ(5 * bytes, s.bytes);
+
+	a * b;
+	EXPECT_EQ(2u, cache.stats().hits);
+	a * c;
+	EXPECT_EQ(2u, cache.stats().hits);
+}
+
+TEST(TProductCache, result_larger_than_budget_is_rejected)
+{
+	TProductCache<double> cache(100);
+	TProductCache<double>::install(&cache);
+	TDynamicMatrix<double> a = cache_test_matrix(10, 1.0);
+
+	a * a;
+	a * a;
+
+	TCacheStats s = cache.stats();
+	EXPECT_EQ(2u, s.rejected);
+	EXPECT_EQ(0u, s.entries);
+	EXPECT_EQ(0u, s.hits);
+}
+
+TEST(TProductCache, gemv_applies_scaling_to_cached_product)
+{
+	TDynamicMatrix<double> a = cache_test_matrix(9, 0.5);
+	TDynamicVector<double> x(9), y0(9);
+	for (size_t i = 0; i < 9; ++i) {
+		x[i] = 0.1 * i;
+		y0[i] = 1.0 - i;
+	}
+	TDynamicVector<double> expected(y0);
+	gemv(2.0, a, TTrans::Yes, x, 3.0, expected);
+
+	TProductCache<double> cache(1 << 20);
+	TProductCache<double>::install(&cache);
+	for (int k = 0; k < 2; ++k) {
+		TDynamicVector<double> y(y0);
+		gemv(2.0, a, TTrans::Yes, x, 3.0, y);
+		EXPECT_TRUE(approx_equal(expected, y));
+	}
+	EXPECT_EQ(1u, cache.stats().hits);
+}
+
+TEST(TProductCache, destructor_uninstalls_and_install_returns_previous)
+{
+	TProductCache<double> outer(1 << 10);
+	EXPECT_EQ(nullptr, TProductCache<double>::install(&outer));
+	{
+		TProductCache<double> inner(1 << 10);
+		EXPECT_EQ(&outer, TProductCache<double>::install(&inner));
+	}
+	EXPECT_EQ(nullptr, TProductCache<double>::installed());
+}
+
+TEST(TProductCache, clear_resets_entries_and_stats)
+{
+	TProductCache<double> cache(1 << 20);
+	TProductCache<double>::install(&cache);
+	TDynamicMatrix<double> a = cache_test_matrix(3, 1.0);
+	a * a;
+	a * a;
+	cache.clear();
+
+	TCacheStats s = cache.stats();
+	EXPECT_EQ(0u, s.hits);
+	EXPECT_EQ(0u, s.entries);
+	EXPECT_EQ(0u, s.bytes);
+}
@@ -0,0 +1,234 @@
+#include "tfactor.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<double> make_factor_matrix(size_t n, size_t seed)
+{
+	TDynamicMatrix<double> m(n);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j)
+			m[i][j] = static_cast<double>((i * 7 + j * 13 + seed) % 11) - 5.0;
+		m[i][i] += 3.0 * n;
+	}
+	return m;
+}
+
+// симметричная положительно определённая: B^T B + n I
+static TDynamicMatrix<double> make_spd_matrix(size_t n, size_t seed)
+{
+	TDynamicMatrix<double> a = gram(make_factor_matrix(n, seed));
+	for (size_t i = 0; i < n; ++i)
+		a[i][i] += n;
+	return a;
+}
+
+static TDynamicVector<double> make_factor_vector(size_t n, size_t seed)
+{
+	TDynamicVector<double> v(n);
+	for (size_t i = 0; i < n; ++i)
+		v[i] = static_cast<double>((i * 5 + seed) % 7) - 3.0;
+	return v;
+}
+
+static TDynamicMatrix<double> outer(const TDynamicVector<double>& x, const TDynamicVector<double>& y)
+{
+	TDynamicMatrix<double> m(x.size());
+	ger(1.0, x, y, m);
+	return m;
+}
+
+TEST(TLU, solves_linear_system)
+{
+	const size_t n = 40;
+	TDynamicMatrix<double> a = make_factor_matrix(n, 1);
+	TDynamicVector<double> x = make_factor_vector(n, 2);
+	TDynamicVector<double> b = a * x;
+
+	TLU<double> lu(a);
+
+	EXPECT_TRUE(approx_equal(x, lu.solve(b), 1e-10, 1e-10));
+}
+
+TEST(TLU, pivots_on_zero_diagonal)
+{
+	TDynamicMatrix<double> a(2);
+	a[0][1] = 1.0;
+	a[1][0] = 2.0;
+	TDynamicVector<double> b(2);
+	b[0] = 3.0;
+	b[1] = 4.0;
+
+	TDynamicVector<double> x = TLU<double>(a).solve(b);
+
+	EXPECT_DOUBLE_EQ(2.0, x[0]);
+	EXPECT_DOUBLE_EQ(3.0, x[1]);
+}
+
+TEST(TLU, throws_on_singular_matrix)
+{
+	TDynamicMatrix<double> a(3);
+	ASSERT_ANY_THROW(TLU<double> lu(a));
+}
+
+TEST(TLU, rank_one_update_matches_refactorization)
+{
+	const size_t n = 50;
+	TDynamicMatrix<double> a = make_factor_matrix(n, 3);
+	TDynamicVector<double> x = make_factor_vector(n, 1), y = make_factor_vector(n, 4);
+	TDynamicVector<double> b = make_factor_vector(n, 6);
+
+	TLU<double> lu(a);
+	lu.update(0.5, x, y);
+	ger(0.5, x, y, a);
+
+	EXPECT_TRUE(approx_equal(TLU<double>(a).solve(b), lu.solve(b), 1e-9, 1e-12));
+}
+
+TEST(TLU, rank_k_update_matches_refactorization)
+{
+	const size_t n = 30, k = 3;
+	TDynamicMatrix<double> a = make_factor_matrix(n, 5);
+	TColumnBlock<double> u = make_column_block<double>(n, k), v = make_column_block<double>(n, k);
+	for (size_t p = 0; p < k; ++p) {
+		u[p] = make_factor_vector(n, p);
+		v[p] = make_factor_vector(n, p + 3);
+	}
+	TDynamicVector<double> b = make_factor_vector(n, 2);
+
+	TLU<double> lu(a);
+	lu.update(u, v);
+	rank_k_update(1.0, u, v, a);
+
+	EXPECT_TRUE(approx_equal(TLU<double>(a).solve(b), lu.solve(b), 1e-9, 1e-12));
+}
+
+TEST(TCholesky, factor_reproduces_matrix)
+{
+	const size_t n = 25;
+	TDynamicMatrix<double> a = make_spd_matrix(n, 1);
+
+	TCholesky<double> ch(a);
+	const TDynamicMatrix<double>& r = ch.factor();
+
+	EXPECT_TRUE(approx_equal(a, gram(r), 1e-12, 1e-9));
+	EXPECT_EQ(0.0, r[n - 1][0]);
+}
+
+TEST(TCholesky, throws_on_indefinite_matrix)
+{
+	TDynamicMatrix<double> a(2);
+	a[0][0] = 1.0;
+	a[0][1] = a[1][0] = 2.0;
+	a[1][1] = 1.0;
+	ASSERT_ANY_THROW(TCholesky<double> ch(a));
+}
+
+TEST(TCholesky, solves_linear_system)
+{
+	const size_t n = 30;
+	TDynamicMatrix<double> a = make_spd_matrix(n, 2);
+	TDynamicVector<double> x = make_factor_vector(n, 1);
+
+	EXPECT_TRUE(approx_equal(x, TCholesky<double>(a).solve(a * x), 1e-10, 1e-10));
+}
+
+TEST(TCholesky, update_and_downdate_match_refactorization)
+{
+	const size_t n = 40;
+	TDynamicMatrix<double> a = make_spd_matrix(n, 3);
+	TDynamicVector<double> x = make_factor_vector(n, 2);
+	TCholesky<double> ch(a);
+
+	ch.update(x);
+	TDynamicMatrix<double> a1 = a + outer(x, x);
+	EXPECT_TRUE(approx_equal(TCholesky<double>(a1).factor(), ch.factor(), 1e-10, 1e-10));
+
+	ch.downdate(x);
+	EXPECT_TRUE(approx_equal(TCholesky<double>(a).factor(), ch.factor(), 1e-10, 1e-10));
+}
+
+TEST(TCholesky, failed_downdate_keeps_factor)
+{
+	TDynamicMatrix<double> a(3);
+	for (size_t i = 0; i < 3; ++i)
+		a[i][i] = 1.0;
+	TDynamicVector<double> x(3);
+	x[1] = 2.0;
+	TCholesky<double> ch(a);
+
+	ASSERT_ANY_THROW(ch.downdate(x));
+	EXPECT_EQ(a, ch.factor());
+}
+
+TEST(TCholesky, rank_k_update_matches_refactorization)
+{
+	const size_t n = 20, k = 4;
+	TDynamicMatrix<double> a = make_spd_matrix(n, 4);
+	TColumnBlock<double> u = make_column_block<double>(n, k);
+	for (size_t p = 0; p < k; ++p)
+		u[p] = make_factor_vector(n, p);
+
+	TCholesky<double> ch(a);
+	ch.update(u);
+	symmetric_rank_k_update(1.0, u, a, TTriangle::Upper);
+
+	EXPECT_TRUE(approx_equal(TCholesky<double>(a).factor(), ch.factor(), 1e-10, 1e-10));
+}
+
+static TDynamicMatrix<double> inverse(const TDynamicMatrix<double>& a)
+{
+	size_t n = a.size();
+	TLU<double> lu(a);
+	TDynamicMatrix<double> inv(n);
+	TDynamicVector<double> e(n);
+	for (size_t j = 0; j < n; ++j) {
+		e[j] = 1.0;
+		TDynamicVector<double> col = lu.solve(e);
+		e[j] = 0.0;
+		for (size_t i = 0; i < n; ++i)
+			inv[i][j] = col[i];
+	}
+	return inv;
+}
+
+TEST(TLowRankUpdate, sherman_morrison_matches_inverse)
+{
+	const size_t n = 30;
+	TDynamicMatrix<double> a = make_factor_matrix(n, 2);
+	TDynamicVector<double> u = make_factor_vector(n, 1), v = make_factor_vector(n, 3);
+	TDynamicMatrix<double> ainv = inverse(a);
+
+	sherman_morrison_update(ainv, u, v);
+
+	EXPECT_TRUE(approx_equal(inverse(a + outer(u, v)), ainv, 1e-9, 1e-12));
+}
+
+TEST(TLowRankUpdate, sherman_morrison_rejects_singular_update)
+{
+	TDynamicMatrix<double> ainv(2);
+	ainv[0][0] = ainv[1][1] = 1.0;
+	TDynamicVector<double> u(2), v(2);
+	u[0] = 1.0;
+	v[0] = -1.0;
+	TDynamicMatrix<double> before(ainv);
+
+	ASSERT_ANY_THROW(sherman_morrison_update(ainv, u, v));
+	EXPECT_EQ(before, ainv);
+}
+
+TEST(TLowRankUpdate, woodbury_matches_inverse)
+{
+	const size_t n = 25, k = 3;
+	TDynamicMatrix<double> a = make_factor_matrix(n, 6);
+	TColumnBlock<double> u = make_column_block<double>(n, k), v = make_column_block<double>(n, k);
+	for (size_t p = 0; p < k; ++p) {
+		u[p] = make_factor_vector(n, p + 1);
+		v[p] = make_factor_vector(n, 2 * p);
+	}
+	TDynamicMatrix<double> ainv = inverse(a);
+
+	woodbury_update(ainv, u, v);
+	rank_k_update(1.0, u, v, a);
+
+	EXPECT_TRUE(approx_equal(inverse(a), ainv, 1e-9, 1e-12));
+}
@@ -0,0 +1,165 @@
+#include "thalf.h"
+
+#include <cmath>
+#include <limits>
+#include <gtest.h>
+
+TEST(THalf, float16_occupies_two_bytes)
+{
+	EXPECT_EQ(2, sizeof(TFloat16));
+	EXPECT_EQ(2, sizeof(TBFloat16));
+}
+
+TEST(THalf, float16_represents_exact_values)
+{
+	EXPECT_EQ(0x3c00, TFloat16(1.0f).bits);
+	EXPECT_EQ(0xc000, TFloat16(-2.0f).bits);
+	EXPECT_EQ(0x7bff, TFloat16(65504.0f).bits);
+	EXPECT_EQ(0x0001, TFloat16(5.9604644775390625e-8f).bits);
+	EXPECT_EQ(0.5f, float(TFloat16(0.5f)));
+}
+
+TEST(THalf, float16_rounds_to_nearest_even)
+{
+	// 1 + 2^-11 лежит ровно посередине между 1 и 1 + 2^-10
+	EXPECT_EQ(0x3c00, TFloat16(1.0f + 1.0f / 2048).bits);
+	EXPECT_EQ(0x3c02, TFloat16(1.0f + 3.0f / 2048).bits);
+}
+
+TEST(THalf, float16_handles_overflow_and_nan)
+{
+	EXPECT_EQ(0x7c00, TFloat16(1e6f).bits);
+	EXPECT_TRUE(std::isnan(float(TFloat16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(THalf, bfloat16_keeps_float_range)
+{
+	EXPECT_EQ(0x3f80, TBFloat16(1.0f).bits);
+	EXPECT_NEAR(1e30f, float(TBFloat16(1e30f)), 1e28f);
+	EXPECT_EQ(0x3f80, TBFloat16(1.0f + 1.0f / 256).bits);
+}
+
+TEST(THalf, batch_conversion_matches_scalar)
+{
+	TDynamicVector<float> v(37);
+	for (size_t i = 0; i < 37; ++i)
+		v[i] = std::sin(static_cast<float>(i)) * 100.0f;
+
+	TDynamicVector<TFloat16> h = to_low_precision<TFloat16>(v);
+	TDynamicVector<float> back = to_float_vector(h);
+
+	for (size_t i = 0; i < 37; ++i) {
+		EXPECT_EQ(TFloat16(v[i]).bits, h[i].bits);
+		EXPECT_EQ(float(h[i]), back[i]);
+	}
+}
+
+TEST(THalf, batch_conversion_matches_scalar_for_all_float16_values)
+{
+	// векторный путь F16C и скалярное преобразование должны совпадать,
+	// включая денормализованные числа, бесконечности и хвост массива
+	const size_t n = 65536 + 5;
+	TDynamicVector<TFloat16> h(n);
+	for (size_t i = 0; i < n; ++i)
+		h[i].bits = static_cast<uint16_t>(i);
+	TDynamicVector<float> f = to_float_vector(h);
+	for (size_t i = 0; i < n; ++i) {
+		float expected = half_detail::half_to_float(h[i].bits);
+		if (std::isnan(expected))
+			EXPECT_TRUE(std::isnan(f[i]));
+		else
+			EXPECT_EQ(half_detail::float_bits(expected), half_detail::float_bits(f[i]));
+	}
+
+	TDynamicVector<float> v(n);
+	for (size_t i = 0; i < n; ++i)
+		v[i] = (i % 2 ? -1.0f : 1.0f) * std::ldexp(1.0f + (i % 1021) / 1024.0f, static_cast<int>(i % 48) - 30);
+	TDynamicVector<TFloat16> back = to_low_precision<TFloat16>(v);
+	for (size_t i = 0; i < n; ++i)
+		EXPECT_EQ(half_detail::float_to_half(v[i]), back[i].bits);
+}
+
+TEST(THalf, can_use_float16_in_dynamic_vector)
+{
+	TDynamicVector<TFloat16> a(3), b(3);
+	for (size_t i = 0; i < 3; ++i) {
+		a[i] = static_cast<float>(i);
+		b[i] = 1.5f;
+	}
+	TDynamicVector<TFloat16> c = a + b;
+	EXPECT_EQ(3.5f, float(c[2]));
+}
+
+TEST(THalf, vector_equality_follows_element_equality)
+{
+	TDynamicVector<TFloat16> a(4), b(4);
+	a[0] = 0.0f;
+	b[0] = -0.0f;
+	EXPECT_TRUE(a == b);
+
+	a[1] = std::numeric_limits<float>::quiet_NaN();
+	b[1] = std::numeric_limits<float>::quiet_NaN();
+	EXPECT_FALSE(a == b);
+}
+
+TEST(THalf, equal_vectors_have_equal_hashes)
+{
+	TDynamicVector<TFloat16> a(3), b(3);
+	for (size_t i = 0; i < 3; ++i)
+		a[i] = b[i] = static_cast<float>(i);
+	a[0] = 0.0f;
+	b[0] = -0.0f;
+	ASSERT_TRUE(a == b);
+	EXPECT_EQ(a.hash(), b.hash());
+}
+
+TEST(THalf, dot_accumulates_in_float)
+{
+	// 4096 слагаемых по 1: сумма в float16 застряла бы на 2048
+	TDynamicVector<TFloat16> a(4096), b(4096);
+	for (size_t i = 0; i < 4096; ++i) {
+		a[i] = 1.0f;
+		b[i] = 1.0f;
+	}
+	EXPECT_EQ(4096.0f, dot_f32(a, b));
+}
+
+TEST(THalf, gemv_matches_float_product)
+{
+	TDynamicMatrix<TBFloat16> a(20);
+	TDynamicVector<float> x(20), y(20);
+	for (size_t i = 0; i < 20; ++i) {
+		x[i] = 0.25f * i;
+		for (size_t j = 0; j < 20; ++j)
+			a[i][j] = static_cast<float>((i + j) % 7);
+	}
+	gemv_f32(a, x, y);
+	for (size_t i = 0; i < 20; ++i) {
+		float s = 0;
+		for (size_t j = 0; j < 20; ++j)
+			s += float(a[i][j]) * x[j];
+		EXPECT_EQ(s, y[i]);
+	}
+}
+
+TEST(THalf, gemv_of_large_matrix_matches_double_product)
+{
+	// несколько порций преобразования на строку и параллельные блоки строк
+	const size_t n = 600;
+	TDynamicMatrix<TFloat16> a(n);
+	TDynamicVector<float> x(n), y(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = std::cos(0.1f * i);
+		for (size_t j = 0; j < n; ++j)
+			a[i][j] = std::sin(0.01f * (i * n + j));
+	}
+	gemv_f32(a, x, y);
+	for (size_t i = 0; i < n; ++i) {
+		double s = 0, m = 0;
+		for (size_t j = 0; j < n; ++j) {
+			s += double(float(a[i][j])) * x[j];
+			m += std::fabs(double(float(a[i][j])) * x[j]);
+		}
+		EXPECT_NEAR(s, y[i], 1e-5 * m);
+	}
+}
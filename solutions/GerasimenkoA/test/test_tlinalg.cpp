@@ -0,0 +1,402 @@
+#include "tlinalg.h"
+
+#include <gtest.h>
+
+// матрица ранга 3 с сингулярными числами 10, 5, 1
+static TDynamicMatrix<double> make_low_rank_matrix(size_t n)
+{
+	TDynamicMatrix<double> a(n);
+	const double sigma[3] = { 10.0, 5.0, 1.0 };
+	for (size_t r = 0; r < 3; ++r) {
+		TDynamicVector<double> u(n), v(n);
+		for (size_t i = 0; i < n; ++i) {
+			u[i] = std::cos((r + 1) * (i + 0.5) * 3.14159265358979 / n);
+			v[i] = std::sin((r + 1) * (i + 1) * 3.14159265358979 / (n + 1));
+		}
+		double nu = std::sqrt(dot_product(u, u)), nv = std::sqrt(dot_product(v, v));
+		for (size_t i = 0; i < n; ++i)
+			for (size_t j = 0; j < n; ++j)
+				a[i][j] += sigma[r] * u[i] / nu * v[j] / nv;
+	}
+	return a;
+}
+
+TEST(TLinAlg, qr_produces_orthonormal_columns)
+{
+	TColumnBlock<double> q = make_column_block<double>(6, 3);
+	for (size_t j = 0; j < 3; ++j)
+		for (size_t i = 0; i < 6; ++i)
+			q[j][i] = static_cast<double>((i + 1) * (j + 2) % 7) + (i == j);
+	qr_orthonormalize(q);
+	for (size_t i = 0; i < 3; ++i)
+		for (size_t j = 0; j < 3; ++j)
+			EXPECT_NEAR(i == j ? 1.0 : 0.0, dot_product(q[i], q[j]), 1e-12);
+}
+
+TEST(TLinAlg, randomized_svd_recovers_singular_values)
+{
+	TDynamicMatrix<double> a = make_low_rank_matrix(40);
+	TSvdResult<double> res = randomized_svd(a, 3);
+
+	ASSERT_EQ(3, res.S.size());
+	EXPECT_NEAR(10.0, res.S[0], 1e-9);
+	EXPECT_NEAR(5.0, res.S[1], 1e-9);
+	EXPECT_NEAR(1.0, res.S[2], 1e-9);
+}
+
+TEST(TLinAlg, randomized_svd_reconstructs_low_rank_matrix)
+{
+	TDynamicMatrix<double> a = make_low_rank_matrix(30);
+	TSvdResult<double> res = randomized_svd(a, 3);
+
+	for (size_t i = 0; i < 30; ++i)
+		for (size_t j = 0; j < 30; ++j) {
+			double x = 0;
+			for (size_t r = 0; r < 3; ++r)
+				x += res.U[r][i] * res.S[r] * res.V[r][j];
+			EXPECT_NEAR(a[i][j], x, 1e-9);
+		}
+}
+
+TEST(TLinAlg, single_pass_randomized_svd_recovers_singular_values)
+{
+	TDynamicMatrix<double> a = make_low_rank_matrix(40);
+	TRandomizedSvdParams params;
+	params.singlePass = true;
+	TSvdResult<double> res = randomized_svd(a, 3, params);
+
+	EXPECT_NEAR(10.0, res.S[0], 1e-8);
+	EXPECT_NEAR(5.0, res.S[1], 1e-8);
+	EXPECT_NEAR(1.0, res.S[2], 1e-8);
+}
+
+// матрица m x n ранга 3, заданная строками, с сингулярными числами 10, 5, 1
+static TColumnBlock<double> make_low_rank_rows(size_t m, size_t n)
+{
+	TColumnBlock<double> a = make_column_block<double>(n, m);
+	const double sigma[3] = { 10.0, 5.0, 1.0 };
+	for (size_t r = 0; r < 3; ++r) {
+		TDynamicVector<double> u(m), v(n);
+		for (size_t i = 0; i < m; ++i)
+			u[i] = std::cos((r + 1) * (i + 0.5) * 3.14159265358979 / m);
+		for (size_t j = 0; j < n; ++j)
+			v[j] = std::sin((r + 1) * (j + 1) * 3.14159265358979 / (n + 1));
+		double nu = std::sqrt(dot_product(u, u)), nv = std::sqrt(dot_product(v, v));
+		for (size_t i = 0; i < m; ++i)
+			for (size_t j = 0; j < n; ++j)
+				a[i][j] += sigma[r] * u[i] / nu * v[j] / nv;
+	}
+	return a;
+}
+
+TEST(TLinAlg, randomized_svd_of_tall_and_wide_row_blocks)
+{
+	const size_t shapes[2][2] = { { 300, 40 }, { 25, 70 } };
+	for (const auto& shape : shapes) {
+		size_t m = shape[0], n = shape[1];
+		TColumnBlock<double> a = make_low_rank_rows(m, n);
+		for (int pass = 0; pass < 2; ++pass) {
+			TRandomizedSvdParams params;
+			params.singlePass = pass == 1;
+			TSvdResult<double> res = randomized_svd(a, 3, params);
+
+			ASSERT_EQ(m, res.U[0].size());
+			ASSERT_EQ(n, res.V[0].size());
+			EXPECT_NEAR(10.0, res.S[0], 1e-8);
+			EXPECT_NEAR(5.0, res.S[1], 1e-8);
+			EXPECT_NEAR(1.0, res.S[2], 1e-8);
+			for (size_t i = 0; i < m; i += 7)
+				for (size_t j = 0; j < n; ++j) {
+					double x = 0;
+					for (size_t r = 0; r < 3; ++r)
+						x += res.U[r][i] * res.S[r] * res.V[r][j];
+					EXPECT_NEAR(a[i][j], x, 1e-8);
+				}
+		}
+	}
+}
+
+TEST(TLinAlg, randomized_svd_of_row_block_checks_shape)
+{
+	TColumnBlock<double> a = make_column_block<double>(5, 20);
+	ASSERT_ANY_THROW(randomized_svd(a, 6));
+	a[3] = TDynamicVector<double>(4);
+	ASSERT_ANY_THROW(randomized_svd(a, 2));
+}
+
+TEST(TLinAlg, randomized_svd_throws_when_rank_is_too_large)
+{
+	TDynamicMatrix<double> a(4);
+	ASSERT_ANY_THROW(randomized_svd(a, 5));
+}
+
+TEST(TLinAlg, multiply_into_matches_operator)
+{
+	TDynamicMatrix<int> a(3), b(3), c(3);
+	for (size_t i = 0; i < 3; ++i)
+		for (size_t j = 0; j < 3; ++j) {
+			a[i][j] = static_cast<int>(i + 2 * j);
+			b[i][j] = static_cast<int>(3 * i - j);
+		}
+	multiply_into(a, b, c);
+	EXPECT_EQ(a * b, c);
+}
+
+TEST(TLinAlg, power_computes_fibonacci_numbers)
+{
+	TDynamicMatrix<long long> f(2);
+	f[0][0] = 1; f[0][1] = 1;
+	f[1][0] = 1; f[1][1] = 0;
+
+	TDynamicMatrix<long long> p = power(f, 90);
+
+	EXPECT_EQ(2880067194370816120LL, p[0][1]);
+}
+
+TEST(TLinAlg, zero_power_is_identity)
+{
+	TDynamicMatrix<int> a(3), e(3);
+	for (size_t i = 0; i < 3; ++i) {
+		a[i][i] = 5;
+		e[i][i] = 1;
+	}
+	EXPECT_EQ(e, power(a, 0));
+}
+
+TEST(TLinAlg, power_mod_reduces_entries)
+{
+	TDynamicMatrix<long long> f(2);
+	f[0][0] = 1; f[0][1] = 1;
+	f[1][0] = 1; f[1][1] = 0;
+
+	TDynamicMatrix<long long> p = power_mod(f, 1000000000000ULL, 1000000007LL);
+
+	// F(10^12) mod (10^9 + 7)
+	EXPECT_EQ(730695249LL, p[0][1]);
+}
+
+TEST(TLinAlg, transpose_of_column_block_swaps_dimensions)
+{
+	const size_t n = 45, k = 7;
+	TColumnBlock<double> b = make_column_block<double>(n, k);
+	for (size_t j = 0; j < k; ++j)
+		for (size_t i = 0; i < n; ++i)
+			b[j][i] = static_cast<double>(i * 100 + j);
+
+	TColumnBlock<double> t = transpose(b);
+
+	ASSERT_EQ(n, t.size());
+	ASSERT_EQ(k, t[0].size());
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < k; ++j)
+			EXPECT_EQ(b[j][i], t[i][j]);
+}
+
+static TDynamicMatrix<double> make_test_matrix(size_t n, size_t seed)
+{
+	TDynamicMatrix<double> m(n);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			m[i][j] = static_cast<double>((i * 7 + j * 13 + seed) % 11) - 5.0;
+	return m;
+}
+
+TEST(TLinAlg, multiply_with_transpose_flags_matches_explicit_transpose)
+{
+	const size_t n = 150;
+	TDynamicMatrix<double> a = make_test_matrix(n, 1), b = make_test_matrix(n, 2);
+	TDynamicMatrix<double> at = a.transposed(), bt = b.transposed();
+
+	EXPECT_EQ(a * b, multiply(a, TTrans::No, b, TTrans::No));
+	EXPECT_EQ(at * b, multiply(a, TTrans::Yes, b, TTrans::No));
+	EXPECT_EQ(a * bt, multiply(a, TTrans::No, b, TTrans::Yes));
+	EXPECT_EQ(at * bt, multiply(a, TTrans::Yes, b, TTrans::Yes));
+}
+
+TEST(TLinAlg, syrk_fills_only_requested_triangle)
+{
+	const size_t n = 70;
+	TDynamicMatrix<double> a = make_test_matrix(n, 3);
+	TDynamicMatrix<double> expected = a.transposed() * a;
+	TDynamicMatrix<double> c(n);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			c[i][j] = -1.0;
+
+	syrk(a, TTrans::Yes, c, TTriangle::Lower);
+
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			EXPECT_EQ(j <= i ? expected[i][j] : -1.0, c[i][j]);
+}
+
+TEST(TLinAlg, syrk_without_transpose_computes_a_times_a_transposed)
+{
+	const size_t n = 140;
+	TDynamicMatrix<double> a = make_test_matrix(n, 4);
+	TDynamicMatrix<double> expected = a * a.transposed();
+	TDynamicMatrix<double> c(n);
+
+	syrk(a, TTrans::No, c);
+
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = i; j < n; ++j)
+			EXPECT_EQ(expected[i][j], c[i][j]);
+}
+
+TEST(TLinAlg, gram_is_symmetric_and_matches_product)
+{
+	const size_t n = 200;
+	TDynamicMatrix<double> a = make_test_matrix(n, 5);
+	EXPECT_EQ(a.transposed() * a, gram(a));
+}
+
+TEST(TLinAlg, gemm_scales_and_accumulates_into_destination)
+{
+	const size_t n = 130;
+	TDynamicMatrix<double> a = make_test_matrix(n, 6), b = make_test_matrix(n, 7);
+	TDynamicMatrix<double> c = make_test_matrix(n, 8);
+	TDynamicMatrix<double> expected = a.transposed() * b.transposed() * 2.0;
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			expected[i][j] += 3.0 * c[i][j];
+
+	gemm(2.0, a, TTrans::Yes, b, TTrans::Yes, 3.0, c);
+
+	EXPECT_EQ(expected, c);
+}
+
+TEST(TLinAlg, gemm_with_zero_beta_ignores_nan_in_destination)
+{
+	const size_t n = 10;
+	TDynamicMatrix<double> a = make_test_matrix(n, 1), b = make_test_matrix(n, 2);
+	TDynamicMatrix<double> c(n);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			c[i][j] = std::nan("");
+
+	gemm(1.0, a, TTrans::No, b, TTrans::No, 0.0, c);
+
+	EXPECT_EQ(a * b, c);
+}
+
+TEST(TLinAlg, repeated_gemm_does_not_allocate)
+{
+	const size_t n = 100;
+	TDynamicMatrix<double> a = make_test_matrix(n, 1), b = make_test_matrix(n, 2), c(n);
+	gemm(1.0, a, TTrans::No, b, TTrans::Yes, 0.0, c);
+
+	stats_reset();
+	for (int step = 0; step < 5; ++step)
+		gemm(0.5, a, TTrans::No, b, TTrans::Yes, 1.0, c);
+
+	EXPECT_EQ(0, stats_snapshot().allocations);
+}
+
+TEST(TLinAlg, gemm_marks_destination_changed)
+{
+	const size_t n = 130;
+	TDynamicMatrix<double> a = make_test_matrix(n, 1), b = make_test_matrix(n, 2), c(n);
+	c.track_dirty_rows();
+	uint64_t h = c.hash(), ver = c.version();
+
+	gemm(1.0, a, TTrans::No, b, TTrans::No, 0.0, c);
+
+	EXPECT_GT(c.version(), ver);
+	EXPECT_EQ(n, c.dirty_row_count());
+	EXPECT_NE(h, c.hash());
+}
+
+TEST(TLinAlg, gemv_matches_matrix_vector_product)
+{
+	const size_t n = 300;
+	TDynamicMatrix<double> a = make_test_matrix(n, 9);
+	TDynamicVector<double> x(n), y(n), yt(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = static_cast<double>(i % 5);
+		y[i] = yt[i] = 1.0;
+	}
+	TDynamicVector<double> ax = a * x, atx = a.transposed() * x;
+
+	gemv(2.0, a, TTrans::No, x, -1.0, y);
+	gemv(2.0, a, TTrans::Yes, x, -1.0, yt);
+
+	for (size_t i = 0; i < n; ++i) {
+		EXPECT_EQ(2.0 * ax[i] - 1.0, y[i]);
+		EXPECT_EQ(2.0 * atx[i] - 1.0, yt[i]);
+	}
+}
+
+TEST(TLinAlg, ger_adds_outer_product)
+{
+	const size_t n = 40;
+	TDynamicMatrix<double> a = make_test_matrix(n, 3), expected(a);
+	TDynamicVector<double> x(n), y(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = 1.0 + i % 4;
+		y[i] = 2.0 - i % 3;
+	}
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			expected[i][j] += 0.5 * x[i] * y[j];
+
+	ger(0.5, x, y, a);
+
+	EXPECT_EQ(expected, a);
+}
+
+TEST(TLinAlg, syr_updates_only_requested_triangle)
+{
+	const size_t n = 30;
+	TDynamicMatrix<double> a = make_test_matrix(n, 1), orig(a);
+	TDynamicVector<double> x(n);
+	for (size_t i = 0; i < n; ++i)
+		x[i] = static_cast<double>(i % 5);
+
+	syr(2.0, x, a, TTriangle::Lower);
+
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			EXPECT_EQ(j <= i ? orig[i][j] + 2.0 * x[i] * x[j] : orig[i][j], a[i][j]);
+}
+
+TEST(TLinAlg, rank_k_update_matches_product)
+{
+	const size_t n = 24, k = 3;
+	TDynamicMatrix<double> a = make_test_matrix(n, 2), u(n), v(n);
+	TColumnBlock<double> ub = make_column_block<double>(n, k), vb = make_column_block<double>(n, k);
+	for (size_t p = 0; p < k; ++p)
+		for (size_t i = 0; i < n; ++i) {
+			u[i][p] = ub[p][i] = static_cast<double>((i + p) % 4);
+			v[i][p] = vb[p][i] = static_cast<double>((2 * i + p) % 3) - 1.0;
+		}
+	TDynamicMatrix<double> expected = a + multiply(u, TTrans::No, v, TTrans::Yes) * -1.0;
+
+	rank_k_update(-1.0, ub, vb, a);
+
+	EXPECT_EQ(expected, a);
+}
+
+TEST(TLinAlg, symmetric_rank_k_update_matches_syrk)
+{
+	const size_t n = 20, k = 4;
+	TDynamicMatrix<double> u(n), expected(n), a(n);
+	TColumnBlock<double> ub = make_column_block<double>(n, k);
+	for (size_t p = 0; p < k; ++p)
+		for (size_t i = 0; i < n; ++i)
+			u[i][p] = ub[p][i] = static_cast<double>((3 * i + p) % 5) - 2.0;
+	syrk(u, TTrans::No, expected, TTriangle::Upper);
+
+	symmetric_rank_k_update(1.0, ub, a, TTriangle::Upper);
+
+	EXPECT_EQ(expected, a);
+}
+
+TEST(TLinAlg, rank_updates_check_sizes)
+{
+	TDynamicMatrix<double> a(4);
+	TDynamicVector<double> x(4), y(3);
+	ASSERT_ANY_THROW(ger(1.0, x, y, a));
+	ASSERT_ANY_THROW(syr(1.0, y, a));
+	ASSERT_ANY_THROW(rank_k_update(1.0, make_column_block<double>(4, 2), make_column_block<double>(4, 3), a));
+}
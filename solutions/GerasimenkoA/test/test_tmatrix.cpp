@@ -1,5 +1,7 @@
 #include "tmatrix.h"
 
+#include <sstream>
+#include <unordered_map>
 #include <gtest.h>
 
 TEST(TDynamicMatrix, can_create_matrix_with_positive_length)
@@ -207,3 +209,292 @@ TEST(TDynamicMatrix, cant_subtract_matrixes_with_not_equal_size)
 	ASSERT_ANY_THROW(res = a - b);
 }
 
+
+TEST(TDynamicMatrix, multiply_by_vector_gives_same_result_in_all_sum_modes)
+{
+	TDynamicMatrix<int> m(100);
+	TDynamicVector<int> v(100);
+	for (size_t i = 0; i < 100; ++i) {
+		v[i] = static_cast<int>(i % 7);
+		for (size_t j = 0; j < 100; ++j)
+			m[i][j] = static_cast<int>((i + j) % 11) - 5;
+	}
+	TDynamicVector<int> expected = m * v;
+
+	EXPECT_EQ(expected, m.multiply(v));
+	EXPECT_EQ(expected, m.multiply(v, TSumMode::Reproducible));
+	EXPECT_EQ(expected, m.multiply(v, TSumMode::Kahan));
+}
+
+TEST(TDynamicMatrix, transpose_in_place_swaps_elements)
+{
+	const size_t n = 37;
+	TDynamicMatrix<int> m(n);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			m[i][j] = static_cast<int>(i * n + j);
+
+	m.transpose();
+
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			EXPECT_EQ(static_cast<int>(j * n + i), m[i][j]);
+}
+
+TEST(TDynamicMatrix, transposed_does_not_change_source)
+{
+	const size_t n = 600;
+	TDynamicMatrix<double> m(n);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			m[i][j] = static_cast<double>(i) - 2.0 * j;
+	TDynamicMatrix<double> copy(m);
+
+	TDynamicMatrix<double> t = m.transposed();
+
+	EXPECT_EQ(copy, m);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			ASSERT_EQ(m[j][i], t[i][j]);
+}
+
+TEST(TDynamicMatrix, double_transpose_restores_large_matrix)
+{
+	const size_t n = 700;
+	TDynamicMatrix<int> m(n);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			m[i][j] = static_cast<int>((i * 31 + j * 17) % 1000);
+	TDynamicMatrix<int> copy(m);
+
+	m.transpose().transpose();
+
+	EXPECT_EQ(copy, m);
+}
+
+TEST(TDynamicMatrix, multiply_by_scalar_returns_scaled_copy)
+{
+	TDynamicMatrix<int> m(3);
+	m[1][2] = 4;
+
+	TDynamicMatrix<int> r = m * 3;
+
+	EXPECT_EQ(12, r[1][2]);
+	EXPECT_EQ(4, m[1][2]);
+}
+
+TEST(TDynamicMatrix, multiply_by_vector_matches_row_dot_products_exactly)
+{
+	const size_t n = 203;
+	TDynamicMatrix<float> m(n);
+	TDynamicVector<float> v(n);
+	for (size_t i = 0; i < n; ++i) {
+		v[i] = 1.0f / static_cast<float>(i + 1);
+		for (size_t j = 0; j < n; ++j)
+			m[i][j] = std::sin(static_cast<float>(i * n + j));
+	}
+
+	TDynamicVector<float> r = m * v;
+
+	for (size_t i = 0; i < n; ++i)
+		EXPECT_EQ(m[i].dot(v), r[i]);
+}
+
+TEST(TDynamicMatrix, left_multiply_computes_row_vector_times_matrix)
+{
+	const size_t n = 1100;
+	TDynamicMatrix<double> m(n);
+	TDynamicVector<double> x(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = static_cast<double>(i % 3);
+		for (size_t j = 0; j < n; ++j)
+			m[i][j] = static_cast<double>((i + 2 * j) % 5);
+	}
+
+	TDynamicVector<double> r = m.left_multiply(x);
+
+	EXPECT_EQ(m.transposed() * x, r);
+}
+
+TEST(TDynamicMatrix, cant_left_multiply_by_vector_of_other_size)
+{
+	TDynamicMatrix<int> m(3);
+	TDynamicVector<int> x(4);
+	ASSERT_ANY_THROW(m.left_multiply(x));
+}
+
+TEST(TDynamicMatrix, approx_equal_compares_all_rows)
+{
+	TDynamicMatrix<float> a(70), b(70);
+	for (size_t i = 0; i < 70; ++i)
+		for (size_t j = 0; j < 70; ++j)
+			a[i][j] = b[i][j] = static_cast<float>(i) - static_cast<float>(j);
+	a[69][0] += 1e-4f;
+	EXPECT_FALSE(a == b);
+	EXPECT_TRUE(approx_equal(a, b));
+
+	a[69][0] += 0.5f;
+	EXPECT_FALSE(approx_equal(a, b));
+}
+
+TEST(TDynamicMatrix, hash_changes_when_element_changes)
+{
+	TDynamicMatrix<int> a(20), b(20);
+	EXPECT_EQ(a.hash(), b.hash());
+	b[19][0] = 1;
+	EXPECT_NE(a.hash(), b.hash());
+	EXPECT_FALSE(a == b);
+	b[19][0] = 0;
+	EXPECT_EQ(a.hash(), b.hash());
+}
+
+TEST(TDynamicMatrix, transpose_invalidates_hash)
+{
+	TDynamicMatrix<int> m(5);
+	m[0][1] = 1;
+	uint64_t h = m.hash();
+	m.transpose();
+	EXPECT_NE(h, m.hash());
+}
+
+TEST(TDynamicMatrix, can_be_key_of_unordered_map)
+{
+	std::unordered_map<TDynamicMatrix<int>, int> cache;
+	TDynamicMatrix<int> a(4), b(4);
+	b[2][3] = 5;
+	cache[a] = 1;
+	cache[b] = 2;
+	TDynamicMatrix<int> c(b);
+	EXPECT_EQ(2, cache.size());
+	EXPECT_EQ(2, cache[c]);
+}
+
+TEST(TDynamicMatrix, version_sees_writes_through_row_reference)
+{
+	TDynamicMatrix<int> m(6);
+	TDynamicVector<int>& row = m[2];
+	uint64_t ver = m.version();
+	row[4] = 1;
+	EXPECT_GT(m.version(), ver);
+	ver = m.version();
+	const TDynamicMatrix<int>& cm = m;
+	EXPECT_EQ(1, cm[2][4]);
+	EXPECT_EQ(ver, m.version());
+}
+
+TEST(TDynamicMatrix, whole_matrix_operations_increase_version)
+{
+	TDynamicMatrix<int> m(4), n(4);
+	uint64_t ver = m.version();
+	m.transpose();
+	EXPECT_GT(m.version(), ver);
+	ver = m.version();
+	m = n;
+	EXPECT_GT(m.version(), ver);
+	ver = m.version();
+	std::istringstream in("1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16");
+	in >> m;
+	EXPECT_GT(m.version(), ver);
+}
+
+TEST(TDynamicMatrix, rows_are_dirty_without_tracking)
+{
+	TDynamicMatrix<int> m(3);
+	EXPECT_FALSE(m.tracks_dirty_rows());
+	EXPECT_TRUE(m.row_dirty(1));
+	EXPECT_EQ(3, m.dirty_row_count());
+	ASSERT_ANY_THROW(m.row_dirty(3));
+}
+
+TEST(TDynamicMatrix, tracks_rows_written_through_accessors)
+{
+	TDynamicMatrix<int> m(130);
+	m.track_dirty_rows();
+	EXPECT_EQ(0, m.dirty_row_count());
+	m[5][0] = 1;
+	m.at(129)[1] = 2;
+	const TDynamicMatrix<int>& cm = m;
+	int s = cm[7][0] + cm.at(8)[0];
+	EXPECT_EQ(0, s);
+
+	EXPECT_EQ(2, m.dirty_row_count());
+	EXPECT_TRUE(m.row_dirty(5));
+	EXPECT_TRUE(m.row_dirty(129));
+	EXPECT_FALSE(m.row_dirty(7));
+	EXPECT_FALSE(m.row_dirty(8));
+
+	m.clear_dirty_rows();
+	EXPECT_EQ(0, m.dirty_row_count());
+	m.track_dirty_rows(false);
+	EXPECT_FALSE(m.tracks_dirty_rows());
+}
+
+TEST(TDynamicMatrix, whole_matrix_operations_mark_all_rows_dirty)
+{
+	TDynamicMatrix<int> m(70), n(70);
+	m.track_dirty_rows();
+	m.transpose();
+	EXPECT_EQ(70, m.dirty_row_count());
+	m.clear_dirty_rows();
+	m = n;
+	EXPECT_TRUE(m.tracks_dirty_rows());
+	EXPECT_EQ(70, m.dirty_row_count());
+}
+
+TEST(TDynamicMatrix, move_assignment_of_larger_matrix_marks_all_rows_dirty)
+{
+	TDynamicMatrix<int> m(3), tracked(5), plain(5);
+	m.track_dirty_rows();
+	tracked.track_dirty_rows();
+
+	m = std::move(tracked);
+	EXPECT_TRUE(m.tracks_dirty_rows());
+	EXPECT_EQ(5, m.dirty_row_count());
+
+	TDynamicMatrix<int> k(3);
+	k.track_dirty_rows();
+	k = std::move(plain);
+	EXPECT_EQ(5, k.dirty_row_count());
+	EXPECT_TRUE(k.row_dirty(4));
+}
+
+TEST(TDynamicMatrix, dirty_rows_allow_incremental_product)
+{
+	const size_t n = 100;
+	TDynamicMatrix<double> a(n);
+	TDynamicVector<double> x(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = 1.0 + i % 3;
+		for (size_t j = 0; j < n; ++j)
+			a[i][j] = 0.01 * (i + j);
+	}
+	TDynamicVector<double> y = a * x;
+	a.track_dirty_rows();
+	a[10][3] = 7.0;
+	a[77][50] = -2.0;
+
+	const TDynamicMatrix<double>& ca = a;
+	for (size_t i = 0; i < n; ++i)
+		if (a.row_dirty(i))
+			y[i] = ca[i].dot(x);
+	a.clear_dirty_rows();
+
+	EXPECT_TRUE(approx_equal(a * x, y));
+}
+
+TEST(TDynamicMatrix, products_keep_operand_versions)
+{
+	TDynamicMatrix<int> a(5), b(5);
+	TDynamicVector<int> x(5);
+	a[1][2] = 3;
+	b[2][4] = 2;
+	uint64_t va = a.version(), vb = b.version();
+
+	TDynamicMatrix<int> c = a * b;
+	TDynamicVector<int> y = a * x;
+	TDynamicMatrix<int> t = a.transposed();
+
+	EXPECT_EQ(6, c[1][4]);
+	EXPECT_EQ(va, a.version());
+	EXPECT_EQ(vb, b.version());
+}
@@ -0,0 +1,73 @@
+#include "tperf.h"
+#include "tmatrix.h"
+
+#include <future>
+#include <thread>
+#include <gtest.h>
+
+TEST(TPerf, empty_sample_difference_is_zero)
+{
+	TPerfSample a;
+	TPerfSample d = a - a;
+	EXPECT_EQ(0, d.cycles);
+	EXPECT_EQ(0, d.instructions);
+}
+
+TEST(TPerf, counters_are_monotonic_or_unavailable)
+{
+	TPerfCounters& perf = thread_perf_counters();
+	TPerfSample before = perf.read();
+	volatile double s = 0;
+	for (int i = 0; i < 100000; ++i)
+		s = s + i;
+	TPerfSample after = perf.read();
+
+	if (perf.available()) {
+		EXPECT_GT(after.cycles, before.cycles);
+		EXPECT_GE(after.instructions, before.instructions);
+	}
+	else {
+		EXPECT_EQ(0, after.cycles);
+		EXPECT_EQ(0, after.instructions);
+	}
+}
+
+TEST(TPerf, op_stats_record_hardware_counters_only_when_enabled)
+{
+	stats_reset();
+	TDynamicMatrix<double> a(40), b(40);
+	for (size_t i = 0; i < 40; ++i)
+		a[i][i] = b[i][i] = 1.0;
+	TDynamicMatrix<double> c = a * b;
+	TOpStats s = stats_snapshot()[TOpKind::Gemm];
+
+	EXPECT_EQ(stats_enabled() ? 1 : 0, s.calls);
+	if (perf_enabled() && thread_perf_counters().available())
+		EXPECT_GT(s.hw.cycles, 0);
+	else
+		EXPECT_EQ(0, s.hw.cycles);
+}
+
+TEST(TPerf, counters_include_threads_started_after_opening)
+{
+	TPerfCounters& perf = thread_perf_counters();
+	TPerfSample before = perf.read();
+	std::promise<void> done, release;
+	std::future<void> finished = release.get_future();
+	std::thread worker([&] {
+		volatile double s = 0;
+		for (int i = 0; i < 1000000; ++i)
+			s = s + i;
+		done.set_value();
+		finished.wait();
+	});
+	done.get_future().wait();
+	TPerfSample after = perf.read();
+	release.set_value();
+	worker.join();
+
+	if (perf.available())
+		EXPECT_GT(after.instructions - before.instructions, 1000000u);
+	else
+		EXPECT_EQ(0, after.instructions);
+}
@@ -0,0 +1,76 @@
+#include "tquantized.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<float> make_float_matrix(size_t n, float shift)
+{
+	TDynamicMatrix<float> m(n);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			m[i][j] = std::sin(i * 0.7f + j * 0.3f + shift) * (1.0f + i % 3);
+	return m;
+}
+
+TEST(TQuantizedMatrix, quantized_values_fit_int8_range)
+{
+	TQuantizedMatrix q(make_float_matrix(10, 0.0f));
+	for (size_t i = 0; i < 10; ++i)
+		for (size_t j = 0; j < 10; ++j) {
+			EXPECT_LE(q.value(i, j), 127);
+			EXPECT_GE(q.value(i, j), -127);
+		}
+}
+
+TEST(TQuantizedMatrix, dequantize_is_close_to_source)
+{
+	TDynamicMatrix<float> m = make_float_matrix(16, 0.5f);
+	for (TQuantAxis axis : { TQuantAxis::Rows, TQuantAxis::Columns }) {
+		TDynamicMatrix<float> d = dequantize(quantize(m, axis));
+		for (size_t i = 0; i < 16; ++i)
+			for (size_t j = 0; j < 16; ++j)
+				EXPECT_NEAR(m[i][j], d[i][j], 3.0f / 254);
+	}
+}
+
+TEST(TQuantizedMatrix, zero_row_is_quantized_to_zero)
+{
+	TDynamicMatrix<float> m(4);
+	m[1][2] = 5.0f;
+	TQuantizedMatrix q(m);
+	EXPECT_EQ(0, q.value(0, 0));
+	EXPECT_EQ(127, q.value(1, 2));
+}
+
+TEST(TQuantizedMatrix, quantized_product_approximates_float_product)
+{
+	size_t n = 70;
+	TDynamicMatrix<float> a = make_float_matrix(n, 0.0f), b = make_float_matrix(n, 1.0f);
+	TDynamicMatrix<float> exact = a * b;
+	TDynamicMatrix<float> c = quantized_multiply(quantize(a, TQuantAxis::Rows), quantize(b, TQuantAxis::Columns));
+
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			EXPECT_NEAR(exact[i][j], c[i][j], 0.5f);
+}
+
+TEST(TQuantizedMatrix, quantized_product_is_exact_for_integer_data)
+{
+	TDynamicMatrix<float> a(40), b(40);
+	for (size_t i = 0; i < 40; ++i)
+		for (size_t j = 0; j < 40; ++j) {
+			a[i][j] = static_cast<float>(static_cast<int>((i * 5 + j) % 255) - 127);
+			b[i][j] = static_cast<float>(static_cast<int>((i + j * 11) % 255) - 127);
+		}
+	a[0][0] = b[0][0] = 127.0f; // масштаб каждой строки/столбца ровно 1
+	for (size_t i = 0; i < 40; ++i) {
+		a[i][39] = 127.0f;
+		b[39][i] = 127.0f;
+	}
+	EXPECT_EQ(a * b, quantized_multiply(quantize(a), quantize(b, TQuantAxis::Columns)));
+}
+
+TEST(TQuantizedMatrix, throws_when_operands_have_wrong_axes)
+{
+	TDynamicMatrix<float> a = make_float_matrix(4, 0.0f);
+	ASSERT_ANY_THROW(quantized_multiply(quantize(a), quantize(a)));
+}
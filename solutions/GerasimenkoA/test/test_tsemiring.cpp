@@ -0,0 +1,81 @@
+#include "tsemiring.h"
+
+#include <gtest.h>
+
+TEST(TSemiring, plus_times_product_matches_operator)
+{
+	TDynamicMatrix<double> a(70), b(70);
+	for (size_t i = 0; i < 70; ++i)
+		for (size_t j = 0; j < 70; ++j) {
+			a[i][j] = static_cast<double>((i * 7 + j) % 11);
+			b[i][j] = static_cast<double>((i + j * 3) % 5);
+		}
+	EXPECT_EQ(a * b, semiring_multiply<TPlusTimes<double>>(a, b));
+}
+
+TEST(TSemiring, min_plus_squaring_gives_two_step_shortest_paths)
+{
+	const int inf = semiring_infinity<int>();
+	TDynamicMatrix<int> d(3);
+	d[0][0] = 0;   d[0][1] = 4;   d[0][2] = 1;
+	d[1][0] = inf; d[1][1] = 0;   d[1][2] = inf;
+	d[2][0] = inf; d[2][1] = 2;   d[2][2] = 0;
+
+	TDynamicMatrix<int> d2 = semiring_multiply<TMinPlus<int>>(d, d);
+
+	EXPECT_EQ(3, d2[0][1]);
+	EXPECT_EQ(1, d2[0][2]);
+	EXPECT_EQ(inf, d2[1][0]);
+}
+
+TEST(TSemiring, min_plus_float_handles_infinity)
+{
+	const float inf = semiring_infinity<float>();
+	TDynamicMatrix<float> d(2);
+	d[0][0] = 0; d[0][1] = 1.5f;
+	d[1][0] = inf; d[1][1] = 0;
+
+	TDynamicMatrix<float> d2 = semiring_multiply<TMinPlus<float>>(d, d);
+
+	EXPECT_EQ(1.5f, d2[0][1]);
+	EXPECT_EQ(inf, d2[1][0]);
+}
+
+TEST(TSemiring, max_plus_selects_best_path)
+{
+	TDynamicMatrix<int> w(2);
+	w[0][0] = 1; w[0][1] = 5;
+	w[1][0] = 2; w[1][1] = 3;
+
+	TDynamicMatrix<int> w2 = semiring_multiply<TMaxPlus<int>>(w, w);
+
+	EXPECT_EQ(7, w2[0][0]);
+	EXPECT_EQ(8, w2[0][1]);
+}
+
+TEST(TSemiring, or_and_product_gives_reachability)
+{
+	TDynamicMatrix<bool> g(3);
+	g[0][1] = true;
+	g[1][2] = true;
+
+	TDynamicMatrix<bool> g2 = semiring_multiply<TOrAnd>(g, g);
+
+	EXPECT_TRUE(g2[0][2]);
+	EXPECT_FALSE(g2[0][1]);
+	EXPECT_FALSE(g2[2][0]);
+}
+
+TEST(TSemiring, throws_when_sizes_mismatch)
+{
+	TDynamicMatrix<int> a(3), b(4);
+	ASSERT_ANY_THROW(semiring_multiply<TMinPlus<int>>(a, b));
+}
+
+TEST(TSemiring, throws_when_result_is_an_operand)
+{
+	TDynamicMatrix<int> a(3), b(3);
+	ASSERT_ANY_THROW(semiring_multiply_into(a, b, a, TMinPlus<int>()));
+	ASSERT_ANY_THROW(semiring_multiply_into(a, b, b, TMinPlus<int>()));
+	ASSERT_ANY_THROW(semiring_multiply_into(a, TTrans::Yes, a, TTrans::Yes, a, TPlusTimes<int>()));
+}
@@ -0,0 +1,156 @@
+#include "tsolvers.h"
+
+#include <gtest.h>
+
+// трёхдиагональная матрица с диагональным преобладанием;
+// при skew != 0 матрица несимметрична
+static TDynamicMatrix<double> make_system_matrix(size_t n, double skew = 0.0)
+{
+	TDynamicMatrix<double> a(n);
+	for (size_t i = 0; i < n; ++i) {
+		a[i][i] = 4.0;
+		if (i > 0) a[i][i - 1] = -1.0 - skew;
+		if (i + 1 < n) a[i][i + 1] = -1.0 + skew;
+	}
+	return a;
+}
+
+static double residual_norm(const TDynamicMatrix<double>& a,
+	const TDynamicVector<double>& x, const TDynamicVector<double>& b)
+{
+	double s = 0;
+	for (size_t i = 0; i < a.size(); ++i) {
+		double r = b[i] - dot_product(a[i], x);
+		s += r * r;
+	}
+	return std::sqrt(s);
+}
+
+TEST(TSolvers, cg_solves_symmetric_system)
+{
+	TDynamicMatrix<double> a = make_system_matrix(50);
+	TDynamicVector<double> b(50), x(50);
+	for (size_t i = 0; i < 50; ++i)
+		b[i] = 1.0 + i % 3;
+
+	TSolverResult<double> res = cg(make_operator(a), b, x);
+
+	EXPECT_TRUE(res.converged);
+	EXPECT_LT(residual_norm(a, x, b), 1e-6);
+	EXPECT_EQ(res.iterations, res.residuals.size());
+	EXPECT_EQ(res.iterations, res.iterationSeconds.size());
+}
+
+TEST(TSolvers, cg_with_jacobi_preconditioner_converges)
+{
+	TDynamicMatrix<double> a = make_system_matrix(50);
+	TDynamicVector<double> b(50), x(50);
+	for (size_t i = 0; i < 50; ++i)
+		b[i] = 1.0;
+
+	TSolverResult<double> res = cg(make_operator(a), b, x, TSolverParams(),
+		TJacobiPreconditioner<double>(a));
+
+	EXPECT_TRUE(res.converged);
+	EXPECT_LT(residual_norm(a, x, b), 1e-6);
+}
+
+TEST(TSolvers, cg_stops_on_indefinite_matrix)
+{
+	// diag(1, -1): p^T * A * p на первом шаге равно нулю
+	TDynamicMatrix<double> a(2);
+	a[0][0] = 1.0;
+	a[1][1] = -1.0;
+	TDynamicVector<double> b(2), x(2);
+	b[0] = b[1] = 1.0;
+
+	TSolverResult<double> res = cg(make_operator(a), b, x);
+
+	EXPECT_FALSE(res.converged);
+	EXPECT_EQ(0u, res.iterations);
+	EXPECT_EQ(0.0, x[0]);
+	EXPECT_EQ(0.0, x[1]);
+}
+
+TEST(TSolvers, cg_stops_on_indefinite_preconditioner)
+{
+	TDynamicMatrix<double> a = make_system_matrix(10);
+	TDynamicVector<double> b(10), x(10);
+	for (size_t i = 0; i < 10; ++i)
+		b[i] = 1.0;
+	auto negate = [](const TDynamicVector<double>& r, TDynamicVector<double>& z) {
+		for (size_t i = 0; i < r.size(); ++i)
+			z[i] = -r[i];
+	};
+
+	TSolverResult<double> res = cg(make_operator(a), b, x, TSolverParams(), negate);
+
+	EXPECT_FALSE(res.converged);
+	EXPECT_EQ(0u, res.iterations);
+}
+
+TEST(TSolvers, bicgstab_solves_nonsymmetric_system)
+{
+	TDynamicMatrix<double> a = make_system_matrix(40, 0.5);
+	TDynamicVector<double> b(40), x(40);
+	for (size_t i = 0; i < 40; ++i)
+		b[i] = static_cast<double>(i % 5);
+
+	TSolverResult<double> res = bicgstab(make_operator(a), b, x);
+
+	EXPECT_TRUE(res.converged);
+	EXPECT_LT(residual_norm(a, x, b), 1e-6);
+}
+
+TEST(TSolvers, gmres_solves_nonsymmetric_system_with_restarts)
+{
+	TDynamicMatrix<double> a = make_system_matrix(40, 0.5);
+	TDynamicVector<double> b(40), x(40);
+	for (size_t i = 0; i < 40; ++i)
+		b[i] = static_cast<double>(i % 5);
+	TSolverParams params;
+	params.restart = 5;
+
+	TSolverResult<double> res = gmres(make_operator(a), b, x, params);
+
+	EXPECT_TRUE(res.converged);
+	EXPECT_LT(residual_norm(a, x, b), 1e-6);
+}
+
+TEST(TSolvers, ilu0_is_exact_for_tridiagonal_matrix)
+{
+	TDynamicMatrix<double> a = make_system_matrix(30, 0.5);
+	TDynamicVector<double> b(30), x(30);
+	for (size_t i = 0; i < 30; ++i)
+		b[i] = 1.0;
+
+	TSolverResult<double> res = gmres(make_operator(a), b, x, TSolverParams(),
+		TIlu0Preconditioner<double>(a));
+
+	EXPECT_TRUE(res.converged);
+	EXPECT_LE(res.iterations, 2);
+}
+
+TEST(TSolvers, solver_accepts_any_operator)
+{
+	// оператор задан без матрицы: y = 3 * x
+	auto op = [](const TDynamicVector<double>& x, TDynamicVector<double>& y) {
+		for (size_t i = 0; i < x.size(); ++i)
+			y[i] = 3.0 * x[i];
+	};
+	TDynamicVector<double> b(10), x(10);
+	for (size_t i = 0; i < 10; ++i)
+		b[i] = 3.0 * i;
+
+	TSolverResult<double> res = cg(op, b, x);
+
+	EXPECT_TRUE(res.converged);
+	EXPECT_NEAR(7.0, x[7], 1e-9);
+}
+
+TEST(TSolvers, throws_when_sizes_mismatch)
+{
+	TDynamicMatrix<double> a = make_system_matrix(5);
+	TDynamicVector<double> b(5), x(4);
+	ASSERT_ANY_THROW(cg(make_operator(a), b, x));
+}
@@ -0,0 +1,82 @@
+#include "tstaticmatrix.h"
+
+#include <gtest.h>
+
+TEST(TStaticVector, can_be_used_in_constant_expression)
+{
+	constexpr TStaticVector<int, 3> a{ 1, 2, 3 }, b{ 4, 5, 6 };
+	static_assert(a * b == 32, "dot product must be computed at compile time");
+	static_assert((a + b)[2] == 9, "sum must be computed at compile time");
+	EXPECT_EQ(3, a.size());
+}
+
+TEST(TStaticVector, has_no_heap_storage)
+{
+	EXPECT_EQ(4 * sizeof(float), sizeof(TStaticVector<float, 4>));
+	EXPECT_EQ(16 * sizeof(float), sizeof(TStaticMatrix<float, 4>));
+}
+
+TEST(TStaticVector, scalar_operations)
+{
+	TStaticVector<int, 2> v{ 1, 2 };
+	EXPECT_EQ((TStaticVector<int, 2>{ 3, 4 }), v + 2);
+	EXPECT_EQ((TStaticVector<int, 2>{ 0, 1 }), v - 1);
+	EXPECT_EQ((TStaticVector<int, 2>{ 3, 6 }), v * 3);
+}
+
+TEST(TStaticVector, throws_when_get_element_with_too_large_index)
+{
+	TStaticVector<int, 2> v;
+	ASSERT_ANY_THROW(v.at(2));
+}
+
+TEST(TStaticVector, converts_to_and_from_dynamic_vector)
+{
+	TStaticVector<double, 3> v{ 1.5, 2.5, 3.5 };
+	TDynamicVector<double> d = v.to_dynamic();
+	EXPECT_EQ(2.5, d[1]);
+	EXPECT_EQ(v, (TStaticVector<double, 3>(d)));
+	ASSERT_ANY_THROW((TStaticVector<double, 4>(d)));
+}
+
+TEST(TStaticMatrix, can_be_used_in_constant_expression)
+{
+	constexpr TStaticMatrix<int, 2> a{ { 1, 2 }, { 3, 4 } };
+	constexpr TStaticMatrix<int, 2> c = a * a;
+	static_assert(c[0][0] == 7 && c[0][1] == 10 && c[1][0] == 15 && c[1][1] == 22,
+		"product must be computed at compile time");
+	static_assert(a * TStaticMatrix<int, 2>::identity() == a, "identity must be neutral");
+	SUCCEED();
+}
+
+TEST(TStaticMatrix, product_matches_dynamic_matrix)
+{
+	TStaticMatrix<double, 4> a, b;
+	for (size_t i = 0; i < 4; ++i)
+		for (size_t j = 0; j < 4; ++j) {
+			a[i][j] = 0.5 * i + j;
+			b[i][j] = 1.0 * i - 2.0 * j;
+		}
+	TDynamicMatrix<double> da = a.to_dynamic(), db = b.to_dynamic();
+
+	EXPECT_EQ(da * db, (a * b).to_dynamic());
+	EXPECT_EQ(da + db, (a + b).to_dynamic());
+	EXPECT_EQ(da - db, (a - b).to_dynamic());
+}
+
+TEST(TStaticMatrix, can_multiply_matrix_by_vector)
+{
+	TStaticMatrix<int, 3> m{ { 1, 0, 0 }, { 0, 2, 0 }, { 1, 1, 1 } };
+	TStaticVector<int, 3> v{ 1, 2, 3 };
+	EXPECT_EQ((TStaticVector<int, 3>{ 1, 4, 6 }), m * v);
+	EXPECT_EQ((TStaticMatrix<int, 3>{ { 2, 0, 0 }, { 0, 4, 0 }, { 2, 2, 2 } }), m * 2);
+}
+
+TEST(TStaticMatrix, converts_from_dynamic_matrix)
+{
+	TDynamicMatrix<int> d(2);
+	d[1][0] = 5;
+	TStaticMatrix<int, 2> m(d);
+	EXPECT_EQ(5, m[1][0]);
+	ASSERT_ANY_THROW((TStaticMatrix<int, 3>(d)));
+}
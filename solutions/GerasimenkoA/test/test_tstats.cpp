@@ -0,0 +1,126 @@
+#include "tmatrix.h"
+
+#include <sstream>
+#include <gtest.h>
+
+// test_matrix собирается с TMATRIX_STATS, test_matrix_nostats - без него,
+// см. test/CMakeLists.txt
+
+#ifdef TMATRIX_STATS
+
+TEST(TStats, stats_are_enabled_in_tests)
+{
+	EXPECT_TRUE(stats_enabled());
+}
+
+TEST(TStats, counts_heap_allocations)
+{
+	stats_reset();
+	TDynamicVector<double> v(1000);
+
+	TStatsSnapshot s = stats_snapshot();
+	EXPECT_EQ(1, s.allocations);
+	EXPECT_EQ(1000 * sizeof(double), s.bytesAllocated);
+}
+
+TEST(TStats, short_vectors_do_not_allocate)
+{
+	stats_reset();
+	TDynamicVector<double> v(2);
+	EXPECT_EQ(0, stats_snapshot().allocations);
+}
+
+TEST(TStats, counts_vector_operations)
+{
+	TDynamicVector<double> a(100), b(100);
+	stats_reset();
+	TDynamicVector<double> c = a + b;
+	double d = a * b;
+	(void)d;
+
+	TStatsSnapshot s = stats_snapshot();
+	EXPECT_EQ(1, s[TOpKind::Add].calls);
+	EXPECT_EQ(100, s[TOpKind::Add].flops);
+	EXPECT_EQ(3 * 100 * sizeof(double), s[TOpKind::Add].bytes);
+	EXPECT_EQ(1, s[TOpKind::Dot].calls);
+	EXPECT_EQ(200, s[TOpKind::Dot].flops);
+}
+
+TEST(TStats, matrix_operation_absorbs_row_operations)
+{
+	TDynamicMatrix<double> a(50), b(50);
+	stats_reset();
+	TDynamicMatrix<double> c = a + b;
+
+	TStatsSnapshot s = stats_snapshot();
+	EXPECT_EQ(1, s[TOpKind::Add].calls);
+	EXPECT_EQ(50 * 50, s[TOpKind::Add].flops);
+	EXPECT_EQ(0, s[TOpKind::Dot].calls);
+}
+
+TEST(TStats, counts_gemv_and_gemm_flops)
+{
+	TDynamicMatrix<double> a(100), b(100);
+	TDynamicVector<double> v(100);
+	stats_reset();
+	TDynamicVector<double> x = a.multiply(v);
+	TDynamicVector<double> y = a * v;
+	TDynamicMatrix<double> c = a * b;
+
+	TStatsSnapshot s = stats_snapshot();
+	EXPECT_EQ(2, s[TOpKind::Gemv].calls);
+	EXPECT_EQ(2 * 2 * 100 * 100, s[TOpKind::Gemv].flops);
+	EXPECT_EQ(0, s[TOpKind::Dot].calls);
+	EXPECT_EQ(1, s[TOpKind::Gemm].calls);
+	EXPECT_EQ(2ULL * 100 * 100 * 100, s[TOpKind::Gemm].flops);
+}
+
+TEST(TStats, counts_copies_and_io)
+{
+	TDynamicMatrix<int> a(10);
+	stats_reset();
+	TDynamicMatrix<int> b(a);
+	std::ostringstream out;
+	out << b;
+
+	TStatsSnapshot s = stats_snapshot();
+	EXPECT_EQ(1, s[TOpKind::Copy].calls);
+	EXPECT_EQ(2 * 10 * 10 * sizeof(int), s[TOpKind::Copy].bytes);
+	EXPECT_EQ(1, s[TOpKind::IO].calls);
+}
+
+TEST(TStats, reset_clears_counters)
+{
+	TDynamicVector<double> a(100), b(100);
+	TDynamicVector<double> c = a + b;
+	stats_reset();
+
+	TStatsSnapshot s = stats_snapshot();
+	EXPECT_EQ(0, s.allocations);
+	EXPECT_EQ(0, s[TOpKind::Add].calls);
+	EXPECT_STREQ("add", op_kind_name(TOpKind::Add));
+}
+
+#else
+
+TEST(TStats, stats_are_disabled_without_macro)
+{
+	EXPECT_FALSE(stats_enabled());
+}
+
+TEST(TStats, counters_stay_zero_without_macro)
+{
+	stats_reset();
+	TDynamicMatrix<double> a(100), b(100);
+	TDynamicVector<double> v(1000);
+	TDynamicMatrix<double> c = a * b;
+	TDynamicVector<double> w = v + v;
+
+	TStatsSnapshot s = stats_snapshot();
+	EXPECT_EQ(0, s.allocations);
+	EXPECT_EQ(0, s.bytesAllocated);
+	for (size_t k = 0; k < OP_KIND_COUNT; ++k)
+		EXPECT_EQ(0, s.ops[k].calls);
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include "tmatrix.h"
+
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <gtest.h>
+
+static size_t count_events(const std::vector<TTraceEvent>& events, const char* name)
+{
+	size_t n = 0;
+	for (const TTraceEvent& e : events)
+		if (std::strcmp(e.name, name) == 0) ++n;
+	return n;
+}
+
+TEST(TTrace, is_disabled_by_default)
+{
+	EXPECT_FALSE(trace_enabled());
+}
+
+TEST(TTrace, records_nothing_when_disabled)
+{
+	trace_clear();
+	TDynamicMatrix<double> a(10), b(10);
+	TDynamicMatrix<double> c = a * b;
+	EXPECT_EQ(0, trace_events().size());
+}
+
+TEST(TTrace, records_matrix_operations)
+{
+	TDynamicMatrix<double> a(20), b(20);
+	trace_clear();
+	trace_start();
+	TDynamicMatrix<double> c = a * b;
+	TDynamicVector<double> v(20);
+	TDynamicVector<double> w = a * v;
+	trace_stop();
+
+	std::vector<TTraceEvent> events = trace_events();
+	EXPECT_EQ(1, count_events(events, "gemm"));
+	EXPECT_EQ(1, count_events(events, "gemv"));
+	EXPECT_EQ(1, count_events(events, "matrix_construct"));
+}
+
+TEST(TTrace, row_operations_inside_matrix_operation_are_not_recorded)
+{
+	TDynamicMatrix<double> a(20), b(20);
+	trace_clear();
+	trace_start();
+	TDynamicMatrix<double> c = a + b;
+	trace_stop();
+
+	std::vector<TTraceEvent> events = trace_events();
+	EXPECT_EQ(1, count_events(events, "matrix_add"));
+	EXPECT_EQ(0, count_events(events, "vector_add"));
+	EXPECT_EQ(0, count_events(events, "copy"));
+}
+
+TEST(TTrace, standalone_vector_operation_is_recorded)
+{
+	TDynamicVector<double> a(100), b(100);
+	trace_clear();
+	trace_start();
+	TDynamicVector<double> c = a + b;
+	trace_stop();
+
+	EXPECT_EQ(1, count_events(trace_events(), "vector_add"));
+}
+
+TEST(TTrace, nested_event_lies_inside_outer_event)
+{
+	TDynamicMatrix<double> a(30), b(30);
+	trace_clear();
+	trace_start();
+	TDynamicMatrix<double> c = a * b;
+	trace_stop();
+
+	std::vector<TTraceEvent> events = trace_events();
+	const TTraceEvent* gemm = nullptr;
+	const TTraceEvent* ctor = nullptr;
+	for (const TTraceEvent& e : events) {
+		if (std::strcmp(e.name, "gemm") == 0) gemm = &e;
+		if (std::strcmp(e.name, "matrix_construct") == 0) ctor = &e;
+	}
+	ASSERT_TRUE(gemm != nullptr);
+	ASSERT_TRUE(ctor != nullptr);
+	EXPECT_LE(gemm->start, ctor->start);
+	EXPECT_GE(gemm->start + gemm->duration, ctor->start + ctor->duration);
+}
+
+TEST(TTrace, threads_get_separate_ids)
+{
+	TDynamicMatrix<double> a(10), b(10);
+	trace_clear();
+	trace_start();
+	TDynamicMatrix<double> c = a * b;
+	std::thread worker([&] { TDynamicMatrix<double> d = a * b; });
+	worker.join();
+	trace_stop();
+
+	std::vector<TTraceEvent> events = trace_events();
+	uint32_t first = 0, second = 0;
+	size_t found = 0;
+	for (const TTraceEvent& e : events)
+		if (std::strcmp(e.name, "gemm") == 0)
+			(found++ == 0 ? first : second) = e.thread;
+	ASSERT_EQ(2, found);
+	EXPECT_NE(first, second);
+}
+
+TEST(TTrace, exports_chrome_trace_json)
+{
+	TDynamicMatrix<double> a(10), b(10);
+	trace_clear();
+	trace_start();
+	TDynamicMatrix<double> c = a * b;
+	trace_stop();
+
+	std::ostringstream out;
+	trace_write_chrome(out);
+	std::string json = out.str();
+	EXPECT_EQ(0, json.find("{\"traceEvents\":["));
+	EXPECT_NE(std::string::npos, json.find("\"name\":\"gemm\""));
+	EXPECT_NE(std::string::npos, json.find("\"ph\":\"X\""));
+	EXPECT_EQ(0, trace_dropped());
+}
@@ -237,3 +237,250 @@ TEST(TDynamicVector, cant_multiply_vectors_with_not_equal_size)
 	ASSERT_ANY_THROW(res = a * b);
 }
 
+
+TEST(TDynamicVector, dot_gives_same_result_in_all_sum_modes_for_integers)
+{
+	TDynamicVector<int> a(1000), b(1000);
+	for (size_t i = 0; i < 1000; ++i) {
+		a[i] = static_cast<int>(i % 17) - 8;
+		b[i] = static_cast<int>(i % 5);
+	}
+	int expected = 0;
+	for (size_t i = 0; i < 1000; ++i)
+		expected += a[i] * b[i];
+
+	EXPECT_EQ(expected, a * b);
+	EXPECT_EQ(expected, a.dot(b, TSumMode::Pairwise));
+	EXPECT_EQ(expected, a.dot(b, TSumMode::Kahan));
+}
+
+TEST(TDynamicVector, compensated_sum_is_more_accurate)
+{
+	// 1 + 10^6 слагаемых 1e-8: в наивной сумме float они теряются
+	TDynamicVector<float> v(1000001);
+	v[0] = 1.0f;
+	for (size_t i = 1; i < v.size(); ++i)
+		v[i] = 1e-8f;
+
+	EXPECT_NEAR(1.01f, v.sum(TSumMode::Kahan), 1e-6f);
+	EXPECT_NEAR(1.01f, v.sum(TSumMode::Pairwise), 1e-4f);
+}
+
+TEST(TDynamicVector, cant_dot_vectors_with_not_equal_size)
+{
+	TDynamicVector<double> a(4), b(5);
+	ASSERT_ANY_THROW(a.dot(b, TSumMode::Kahan));
+}
+
+TEST(TDynamicVector, reproducible_dot_matches_fixed_tree_sum)
+{
+	// блоки по 16384 элемента складываются деревом в фиксированном порядке
+	TDynamicVector<double> a(100000), b(100000);
+	for (size_t i = 0; i < a.size(); ++i) {
+		a[i] = std::sin(static_cast<double>(i)) * 1e3;
+		b[i] = std::cos(static_cast<double>(i) * 0.5);
+	}
+	double r1 = a.dot(b, TSumMode::Reproducible);
+	double r2 = a.dot(b, TSumMode::Reproducible);
+
+	EXPECT_EQ(r1, r2);
+	EXPECT_NEAR(a.dot(b, TSumMode::Kahan), r1, 1e-6);
+	EXPECT_NEAR(a.dot(b, TSumMode::Parallel), r1, 1e-6);
+}
+
+TEST(TDynamicVector, can_get_norm)
+{
+	TDynamicVector<double> v(2);
+	v[0] = 3.0;
+	v[1] = 4.0;
+
+	EXPECT_EQ(5.0, v.norm());
+	EXPECT_EQ(5.0, v.norm(TSumMode::Reproducible));
+}
+
+TEST(TDynamicVector, short_vector_is_stored_inline)
+{
+	TDynamicVector<double> small(4), large(1000);
+	EXPECT_TRUE(small.is_small());
+	EXPECT_FALSE(large.is_small());
+	EXPECT_EQ(0.0, small[3]);
+}
+
+TEST(TDynamicVector, moved_short_vector_keeps_values)
+{
+	TDynamicVector<int> a(3);
+	a[0] = 1; a[1] = 2; a[2] = 3;
+
+	TDynamicVector<int> b(std::move(a));
+	EXPECT_TRUE(b.is_small());
+	EXPECT_EQ(3, b[2]);
+
+	TDynamicVector<int> c(100);
+	c = std::move(b);
+	EXPECT_EQ(3, c.size());
+	EXPECT_EQ(2, c[1]);
+}
+
+TEST(TDynamicVector, can_swap_short_and_long_vectors)
+{
+	TDynamicVector<int> a(2), b(50);
+	a[1] = 7;
+	b[49] = 9;
+
+	swap(a, b);
+
+	EXPECT_EQ(50, a.size());
+	EXPECT_EQ(9, a[49]);
+	EXPECT_FALSE(a.is_small());
+	EXPECT_EQ(2, b.size());
+	EXPECT_EQ(7, b[1]);
+	EXPECT_TRUE(b.is_small());
+}
+
+TEST(TDynamicVector, can_assign_between_short_and_long_vectors)
+{
+	TDynamicVector<int> a(2), b(50);
+	a[0] = 5;
+	b[10] = 6;
+
+	b = a;
+	EXPECT_EQ(a, b);
+	EXPECT_TRUE(b.is_small());
+
+	TDynamicVector<int> c(60);
+	c[59] = 1;
+	a = c;
+	EXPECT_EQ(c, a);
+	EXPECT_FALSE(a.is_small());
+}
+
+TEST(TDynamicVector, equality_detects_difference_in_last_element)
+{
+	TDynamicVector<int> a(1000), b(1000);
+	EXPECT_TRUE(a == b);
+	b[999] = 1;
+	EXPECT_FALSE(a == b);
+}
+
+TEST(TDynamicVector, equality_of_floats_follows_ieee_rules)
+{
+	TDynamicVector<double> a(100), b(100);
+	a[5] = 0.0;
+	b[5] = -0.0;
+	EXPECT_TRUE(a == b);
+	a[70] = b[70] = std::nan("");
+	EXPECT_FALSE(a == b);
+}
+
+TEST(TDynamicVector, approx_equal_uses_relative_and_absolute_tolerance)
+{
+	TDynamicVector<double> a(200), b(200);
+	for (size_t i = 0; i < 200; ++i)
+		a[i] = b[i] = 1000.0 + i;
+	a[150] += 1e-3;
+	EXPECT_TRUE(approx_equal(a, b));
+	EXPECT_FALSE(approx_equal(a, b, 0.0, 1e-4));
+	EXPECT_TRUE(approx_equal(a, b, 0.0, 1e-2));
+}
+
+TEST(TDynamicVector, approx_equal_rejects_nan_and_different_sizes)
+{
+	TDynamicVector<double> a(10), b(10), c(11);
+	EXPECT_FALSE(approx_equal(a, c));
+	a[3] = std::nan("");
+	EXPECT_FALSE(approx_equal(a, b));
+}
+
+TEST(TDynamicVector, equal_vectors_have_equal_hashes)
+{
+	TDynamicVector<int> a(1000), b(1000);
+	for (size_t i = 0; i < 1000; ++i)
+		a[i] = b[i] = static_cast<int>(i * i);
+	EXPECT_EQ(a.hash(), b.hash());
+	b[500] = -1;
+	EXPECT_NE(a.hash(), b.hash());
+}
+
+TEST(TDynamicVector, hash_is_invalidated_by_non_const_access)
+{
+	TDynamicVector<double> v(100);
+	uint64_t before = v.hash();
+	v[10] = 3.5;
+	EXPECT_NE(before, v.hash());
+	v.at(10) = 0.0;
+	EXPECT_EQ(before, v.hash());
+}
+
+TEST(TDynamicVector, write_through_reference_taken_before_hash_keeps_old_hash)
+{
+	TDynamicVector<int> a(10), b(10);
+	int& r = a[3];
+	uint64_t before = a.hash();
+	r = 5;
+	b[3] = 5;
+
+	EXPECT_EQ(before, a.hash());
+	EXPECT_NE(a.hash(), b.hash());
+	EXPECT_TRUE(a == b);
+	a[3] = 5;
+	EXPECT_EQ(a.hash(), b.hash());
+}
+
+TEST(TDynamicVector, positive_and_negative_zero_hash_equally)
+{
+	TDynamicVector<float> a(3), b(3);
+	a[1] = 0.0f;
+	b[1] = -0.0f;
+	ASSERT_TRUE(a == b);
+	EXPECT_EQ(a.hash(), b.hash());
+}
+
+TEST(TDynamicVector, hash_depends_on_size_and_tail)
+{
+	TDynamicVector<char> a(9), b(10);
+	EXPECT_NE(a.hash(), b.hash());
+	TDynamicVector<char> c(9);
+	c[8] = 'x';
+	EXPECT_NE(a.hash(), c.hash());
+}
+
+TEST(TDynamicVector, copy_keeps_hash)
+{
+	TDynamicVector<int> a(50);
+	a[7] = 7;
+	uint64_t h = a.hash();
+	TDynamicVector<int> b(a);
+	EXPECT_EQ(h, b.hash());
+	TDynamicVector<int> c(1);
+	c = a;
+	EXPECT_EQ(h, c.hash());
+}
+
+TEST(TDynamicVector, const_access_keeps_version)
+{
+	TDynamicVector<int> v(10);
+	const TDynamicVector<int>& cv = v;
+	uint64_t ver = v.version();
+	int s = cv[3] + cv.at(4) + cv.dot(cv);
+	EXPECT_EQ(0, s);
+	EXPECT_EQ(ver, v.version());
+}
+
+TEST(TDynamicVector, mutation_increases_version)
+{
+	TDynamicVector<int> v(10), w(10);
+	uint64_t ver = v.version();
+	v[1] = 2;
+	EXPECT_GT(v.version(), ver);
+	ver = v.version();
+	v.at(2) = 3;
+	EXPECT_GT(v.version(), ver);
+	ver = v.version();
+	v = w;
+	EXPECT_GT(v.version(), ver);
+	ver = v.version();
+	uint64_t wver = w.version();
+	swap(v, w);
+	EXPECT_GT(v.version(), ver);
+	EXPECT_GT(w.version(), wver);
+}